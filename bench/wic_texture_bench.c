@@ -0,0 +1,186 @@
+/* ----------------------------------------------------------------------------
+ * wic - a simple 2D game engine for Mac OSX written in C
+ * Copyright (C) 2013-2017  Willis O'Leary
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * ----------------------------------------------------------------------------
+ * File:    wic_texture_bench.c
+ * ----------------------------------------------------------------------------
+ */
+/* Times wic_format_buffer against the column-major converter it replaced on a
+ * 3840x2160 image of each format, after checking that both produce the same
+ * bytes. Build and run with "make bench". */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "wic_texture.h"
+#define WIC_BENCH_WIDTH 3840
+#define WIC_BENCH_HEIGHT 2160
+#define WIC_BENCH_RUNS 3
+unsigned char* wic_format_buffer(unsigned char* buffer, WicPair dimensions,
+                                 enum WicFormat format, unsigned channels);
+/* the converter as it was before the row-wise rewrite, kept as a reference */
+unsigned char* wic_format_buffer_reference(unsigned char* buffer,
+                                           WicPair dimensions,
+                                           enum WicFormat format)
+{
+    int x_dimension = (int) (dimensions.x) * 4;
+    int y_dimension = (int) dimensions.y;
+    unsigned char** temp = malloc(x_dimension * sizeof(unsigned char*));
+    if(!temp)
+        return 0;
+    for(int x = 0; x < x_dimension; x++)
+    {
+        temp[x] = malloc(y_dimension * sizeof(unsigned char));
+        if(!temp[x])
+        {
+            for(int i = x-1; i >= 0; i--)
+                free(temp[i]);
+            free(temp);
+            return 0;
+        }
+    }
+    for(int y = 0; y < y_dimension; y++)
+    {
+        for(int x = 0; x < x_dimension; x+=4)
+        {
+            temp[x][y] = 255;
+            temp[x+1][y] = 255;
+            temp[x+2][y] = 255;
+            temp[x+3][y] = 0;
+        }
+    }
+    int buffer_index = 0;
+    for(int y = 0; y < y_dimension; y++)
+    {
+        for(int x = 0; x < x_dimension; x+=4)
+        {
+            if(format == WIC_MONO)
+            {
+                unsigned char character = buffer[buffer_index];
+                if(!character)
+                    temp[x+3][y] = 0;
+                else
+                    temp[x+3][y] = 255;
+                buffer_index++;
+            }
+            else if(format == WIC_GREYSCALE)
+            {
+                temp[x+3][y] = buffer[buffer_index];
+                buffer_index++;
+            }
+            else if(format == WIC_RGB)
+            {
+                temp[x][y] = buffer[buffer_index];
+                temp[x+1][y] = buffer[buffer_index+1];
+                temp[x+2][y] = buffer[buffer_index+2];
+                temp[x+3][y] = 255;
+                buffer_index += 3;
+            }
+            else if(format == WIC_RGBA)
+            {
+                temp[x][y] = buffer[buffer_index];
+                temp[x+1][y] = buffer[buffer_index+1];
+                temp[x+2][y] = buffer[buffer_index+2];
+                temp[x+3][y] = buffer[buffer_index+3];
+                buffer_index += 4;
+            }
+        }
+    }
+    unsigned char* formatted_buffer = malloc(x_dimension * y_dimension *
+                                             sizeof(unsigned char));
+    if(formatted_buffer)
+    {
+        int formatted_buffer_index = 0;
+        for(int y = y_dimension-1; y >= 0; y--) /* flips texture */
+        {
+            for(int x = 0; x < x_dimension; x++)
+            {
+                formatted_buffer[formatted_buffer_index] = temp[x][y];
+                formatted_buffer_index++;
+            }
+        }
+    }
+    for(int x = 0; x < x_dimension; x++)
+        free(temp[x]);
+    free(temp);
+    return formatted_buffer;
+}
+double wic_bench_time()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+/* times one converter on a format; returns the average in ms, or -1 if the
+ * output differs from expected (which may be null to skip the check) */
+double wic_bench_format(unsigned char* buffer, enum WicFormat format,
+                        bool reference, unsigned char* expected)
+{
+    WicPair dimensions = {WIC_BENCH_WIDTH, WIC_BENCH_HEIGHT};
+    size_t size = (size_t) WIC_BENCH_WIDTH * WIC_BENCH_HEIGHT * 4;
+    double start = wic_bench_time();
+    for(int i = 0; i < WIC_BENCH_RUNS; i++)
+    {
+        unsigned char* result = reference ?
+            wic_format_buffer_reference(buffer, dimensions, format) :
+            wic_format_buffer(buffer, dimensions, format, 4);
+        if(!result || (expected && memcmp(result, expected, size)))
+        {
+            free(result);
+            return -1;
+        }
+        free(result);
+    }
+    return (wic_bench_time() - start) / WIC_BENCH_RUNS * 1000;
+}
+int main()
+{
+    const char* names[] = {"MONO", "GREYSCALE", "RGB", "RGBA"};
+    const enum WicFormat formats[] = {WIC_MONO, WIC_GREYSCALE, WIC_RGB,
+                                      WIC_RGBA};
+    WicPair dimensions = {WIC_BENCH_WIDTH, WIC_BENCH_HEIGHT};
+    size_t size = (size_t) WIC_BENCH_WIDTH * WIC_BENCH_HEIGHT * 4;
+    unsigned char* buffer = malloc(size);
+    if(!buffer)
+        return 1;
+    srand(1);
+    /* a third zeros so MONO sees both on and off pixels */
+    for(size_t i = 0; i < size; i++)
+        buffer[i] = rand() % 3 ? rand() : 0;
+    
+    printf("%dx%d, average of %d runs\n", WIC_BENCH_WIDTH, WIC_BENCH_HEIGHT,
+           WIC_BENCH_RUNS);
+    for(int i = 0; i < 4; i++)
+    {
+        unsigned char* expected = wic_format_buffer_reference(buffer,
+                                                              dimensions,
+                                                              formats[i]);
+        if(!expected)
+            return 1;
+        double old_time = wic_bench_format(buffer, formats[i], true, 0);
+        double new_time = wic_bench_format(buffer, formats[i], false,
+                                           expected);
+        free(expected);
+        if(new_time < 0)
+        {
+            printf("%-9s output differs from the reference\n", names[i]);
+            return 1;
+        }
+        printf("%-9s old %8.1f ms  new %6.1f ms  (%.1fx)\n", names[i],
+               old_time, new_time, old_time / new_time);
+    }
+    free(buffer);
+    return 0;
+}
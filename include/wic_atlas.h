@@ -0,0 +1,92 @@
+/* ----------------------------------------------------------------------------
+ * wic - a simple 2D game engine for Mac OSX written in C
+ * Copyright (C) 2013-2017  Willis O'Leary
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * ----------------------------------------------------------------------------
+ * File:    wic_atlas.h
+ * ----------------------------------------------------------------------------
+ */
+/** \file */
+#ifndef WIC_ATLAS_H
+#define WIC_ATLAS_H
+#include <stdlib.h>
+#include "wic_pair.h"
+#include "wic_bounds.h"
+#include "wic_error.h"
+#include "wic_texture.h"
+/** \brief a set of large textures (pages) that many images are packed into
+ *
+ *  Every image added to a WicAtlas is copied into one of its pages, and the
+ *  page's WicTexture is handed back along with the WicBounds of the image 
+ *  within that page. A WicImage initialized with the page texture and given 
+ *  those bounds draws exactly that image. Since images share few textures, 
+ *  they can be drawn with few texture binds, and they batch well with 
+ *  WicSpriteBatch. A transparent pixel of padding surrounds each image, so 
+ *  texture wrapping has no effect on images in an atlas. A WicAtlas should be
+ *  initialized via wic_init_atlas. A WicAtlas should eventually be deallocated
+ *  via wic_free_atlas, which also deallocates its pages.
+ */
+typedef struct WicAtlas WicAtlas;
+/** \brief initializes a WicAtlas
+ *  \param page_dimensions the desired dimensions of each page; both 
+ *         components must be > 0
+ *  \param format the format of the images the atlas will hold; WIC_MONO and 
+ *         WIC_GREYSCALE atlases store a single channel per pixel and only 
+ *         accept WIC_MONO and WIC_GREYSCALE buffers, while WIC_RGB and WIC_RGBA
+ *         atlases accept every format
+ *  \param filter the desired texture filter (defines behavior when textures are
+ *         scaled beyond or below their resolution
+ *  \return a valid pointer to a WicAtlas on success, null on failure
+ */
+WicAtlas* wic_init_atlas(WicPair page_dimensions, enum WicFormat format,
+                         enum WicFilter filter);
+/** \brief packs an existing buffer into a WicAtlas
+ *  \param target the target WicAtlas
+ *  \param buffer the buffer
+ *  \param dimensions the dimensions; dimensions.x * dimensions.y not being 
+ *         equal to the number of elements in buffer will result in undefined 
+ *         behavior; both components must be no greater than the page
+ *         dimensions minus two
+ *  \param format the format of buffer; an incorrect format will result in a
+ *         warped texture and/or undefined behavior; must fit the atlas format
+ *  \param texture the destination of the page texture holding the image
+ *  \param bounds the destination of the image's bounds within the page
+ *  \return true on success, false on failure
+ */
+bool wic_atlas_add_buffer(WicAtlas* target, unsigned char* buffer,
+                          WicPair dimensions, enum WicFormat format,
+                          WicTexture** texture, WicBounds* bounds);
+/** \brief packs a file into a WicAtlas
+ *  \param target the target WicAtlas
+ *  \param filepath the absolute or relative filepath to a non-1bpp and non-RLE 
+ *         BMP, non-interlaced PNG, JPEG, TGA, DDS, PSD, or HDR image file; the
+ *         file must exist and be one of the formentioned formats
+ *  \param texture the destination of the page texture holding the image
+ *  \param bounds the destination of the image's bounds within the page
+ *  \return true on success, false on failure
+ */
+bool wic_atlas_add_file(WicAtlas* target, char* filepath, WicTexture** texture,
+                        WicBounds* bounds);
+/** \brief fetches the number of pages in a WicAtlas
+ *  \param target the target WicAtlas
+ *  \return the number of pages on success, 0 on failure
+ */
+unsigned wic_atlas_get_num_pages(WicAtlas* target);
+/** \brief deallocates a WicAtlas and all of its pages
+ *  \param target the target WicAtlas
+ *  \return true on success, false on failure
+ */
+bool wic_free_atlas(WicAtlas* target);
+#endif
@@ -0,0 +1,76 @@
+/* ----------------------------------------------------------------------------
+ * wic - a simple 2D game engine for Mac OSX written in C
+ * Copyright (C) 2013-2017  Willis O'Leary
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * ----------------------------------------------------------------------------
+ * File:    wic_camera.h
+ * ----------------------------------------------------------------------------
+ */
+/** \file */
+#ifndef WIC_CAMERA_H
+#define WIC_CAMERA_H
+#include <stdbool.h>
+#include <math.h>
+#include "wic_pair.h"
+#include "wic_game.h"
+#include "wic_transform.h"
+/** \brief a view of a 2D world
+ *
+ *  While a WicCamera is set via wic_set_camera, drawables are positioned in
+ *  world coordinates and the GPU maps them to the window, so scrolling a world
+ *  only means moving the WicCamera. A WicCamera should be initialized via
+ *  wic_init_camera.
+ */
+typedef struct WicCamera
+{
+    WicPair location;  /**< the world location shown at the center of the 
+                        *   window */
+    double zoom;       /**< the number of pixels per world unit */
+    double rotation;   /**< the rotation of the view measured in radians; the
+                        *   world appears rotated the opposite way */
+} WicCamera;
+/** \brief initializes a WicCamera with a zoom of 1 and no rotation
+ *  \param target the target WicCamera
+ *  \param location the world location to show at the center of the window
+ *  \return true on success, false on failure
+ */
+bool wic_init_camera(WicCamera* target, WicPair location);
+/** \brief builds the transform from world coordinates to window coordinates
+ *  \param target the target WicCamera
+ *  \param game the WicGame
+ *  \return the transform on success, the identity transform on failure
+ */
+WicTransform wic_get_camera_transform(WicCamera* target, WicGame* game);
+/** \brief converts a window location, such as the cursor location, to the
+ *         world location under it
+ *  \param target the target WicCamera
+ *  \param location the window location
+ *  \param game the WicGame
+ *  \return the world location on success, {-1,-1} on failure
+ */
+WicPair wic_get_world_location(WicCamera* target, WicPair location,
+                               WicGame* game);
+/** \brief sets the view that every following draw is made with
+ *
+ *  The view stays in effect for later frames until it is set again, and can
+ *  be changed within a frame, e.g. to draw a world and then a HUD on top.
+ *  Changing the camera's members has no effect until it is set again.
+ *  \param target the WicCamera to view the world through, or null to draw in
+ *         window coordinates
+ *  \param game the WicGame
+ *  \return true on success, false on failure
+ */
+bool wic_set_camera(WicCamera* target, WicGame* game);
+#endif
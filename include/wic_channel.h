@@ -0,0 +1,171 @@
+/* ----------------------------------------------------------------------------
+ * wic - a simple 2D game engine for Mac OSX written in C
+ * Copyright (C) 2013-2017  Willis O'Leary
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * ----------------------------------------------------------------------------
+ * File:    wic_channel.h
+ * ----------------------------------------------------------------------------
+ */
+/** \file */
+#ifndef WIC_CHANNEL_H
+#define WIC_CHANNEL_H
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include "wic_error.h"
+#include "wic_packet.h"
+/** \brief the maximum number of unacknowledged packets on a reliable channel
+ *
+ *  This matches the 32 bit ack bitfield, so every packet in flight can always
+ *  be acknowledged.
+ */
+#define WIC_CHANNEL_WINDOW 32
+/** \brief identifies how packets sent over a connection are delivered
+ *
+ *  Packets sent with wic_server_send_packet or wic_client_send_packet bypass
+ *  channels entirely and are delivered unreliably and unordered.
+ */
+enum WicChannel
+{
+    WIC_CHANNEL_RELIABLE_ORDERED,    /**< every packet arrives exactly once and
+                                          in the order it was sent */
+    WIC_CHANNEL_RELIABLE_UNORDERED,  /**< every packet arrives exactly once, in
+                                          any order */
+    WIC_CHANNEL_UNRELIABLE_SEQUENCED /**< packets may be lost, and packets
+                                          older than the newest received one
+                                          are dropped */
+};
+/** \brief the send and receive state of one reliable channel */
+typedef struct WicReliableChannel
+{
+    uint16_t next_seq;                        /**< the next sequence number */
+    uint16_t base;                            /**< the oldest unacked one */
+    WicPacket sent[WIC_CHANNEL_WINDOW];       /**< packets kept for resending */
+    double send_times[WIC_CHANNEL_WINDOW];    /**< when each was last sent */
+    double timeouts[WIC_CHANNEL_WINDOW];      /**< when each is resent */
+    bool unacked[WIC_CHANNEL_WINDOW];         /**< whether each is in flight */
+    bool resent[WIC_CHANNEL_WINDOW];          /**< whether each was resent */
+    bool received_any;                        /**< whether recv_seq is valid */
+    uint16_t recv_seq;                        /**< the newest received one */
+    uint32_t recv_bits;                       /**< bit i is set if recv_seq-1-i
+                                               *   was received */
+    bool ack_pending;                         /**< whether an ack is owed */
+    uint16_t next_deliver;                    /**< the next one to deliver in
+                                               *   order */
+    bool buffered[WIC_CHANNEL_WINDOW];        /**< whether each is held back */
+    WicPacket buffer[WIC_CHANNEL_WINDOW];     /**< packets held back until
+                                               *   they can be delivered in
+                                               *   order */
+} WicReliableChannel;
+/** \brief the channel state of one connection between a server and a client
+ *
+ *  A WicConnection is managed by WicServer and WicClient; it only needs to be
+ *  used directly to inspect it. Reliable packets are resent when they are not
+ *  acknowledged within a timeout derived from the measured round trip time.
+ *
+ *  As a rule, the members of a WicConnection should not be altered directly;
+ *  they should be treated as read only.
+ */
+typedef struct WicConnection
+{
+    WicReliableChannel reliable[2]; /**< the reliable channels, indexed by
+                                     *   enum WicChannel */
+    uint16_t next_sequenced;        /**< the next sequenced sequence number */
+    bool received_sequenced;        /**< whether recv_sequenced is valid */
+    uint16_t recv_sequenced;        /**< the newest sequenced one received */
+    bool measured;                  /**< whether rtt has been measured */
+    double rtt;                     /**< the smoothed round trip time */
+    double rtt_var;                 /**< the round trip time variation */
+    double rto;                     /**< the retransmission timeout */
+} WicConnection;
+/** \brief resets a WicConnection to its state before any packets were sent
+ *  \param target the target WicConnection
+ *  \return true on success, false on failure
+ */
+bool wic_reset_connection(WicConnection* target);
+/** \brief returns the time in seconds that channel timeouts are measured in
+ *  \return the time
+ */
+double wic_get_channel_time();
+/** \brief assigns a packet a sequence number on a channel and builds the
+ *         WIC_PACKET_CHANNEL header that must precede it in the same datagram
+ *  \param target the target WicConnection
+ *  \param channel the channel
+ *  \param packet the packet; kept for resending on reliable channels
+ *  \param now the current channel time
+ *  \param result the resulting header
+ *  \return true on success, false on failure
+ */
+bool wic_connection_wrap(WicConnection* target, enum WicChannel channel,
+                         WicPacket* packet, double now, WicPacket* result);
+/** \brief processes a received WIC_PACKET_CHANNEL header and the packet that
+ *         followed it
+ *
+ *  After an in order delivery on WIC_CHANNEL_RELIABLE_ORDERED, packets held
+ *  back behind it are fetched with wic_connection_next_ordered.
+ *  \param target the target WicConnection
+ *  \param header the header
+ *  \param packet the packet that followed the header
+ *  \param now the current channel time
+ *  \return true if the packet should be delivered, false if it is dropped
+ *          (as a duplicate or a stale packet) or held back
+ */
+bool wic_connection_unwrap(WicConnection* target, WicPacket* header,
+                           WicPacket* packet, double now);
+/** \brief fetches the next held back packet that can now be delivered in order
+ *  \param target the target WicConnection
+ *  \param result the destination of the packet
+ *  \return true if there was such a packet, false otherwise
+ */
+bool wic_connection_next_ordered(WicConnection* target, WicPacket* result);
+/** \brief determines whether a held back packet can now be delivered in order,
+ *         without fetching it
+ *  \param target the target WicConnection
+ *  \return true if wic_connection_next_ordered would fetch a packet, false
+ *          otherwise
+ */
+bool wic_connection_has_ordered(WicConnection* target);
+/** \brief processes a received WIC_PACKET_ACK
+ *  \param target the target WicConnection
+ *  \param ack the ack packet
+ *  \param now the current channel time
+ *  \return true on success, false on failure
+ */
+bool wic_connection_receive_ack(WicConnection* target, WicPacket* ack,
+                                double now);
+/** \brief fetches the next reliable packet whose retransmission timeout has
+ *         expired and builds a fresh header for it
+ *  \param target the target WicConnection
+ *  \param now the current channel time
+ *  \param header the resulting header
+ *  \param packet the destination of a pointer to the packet to resend
+ *  \return true if a packet is due, false otherwise
+ */
+bool wic_connection_get_resend(WicConnection* target, double now,
+                               WicPacket* header, WicPacket** packet);
+/** \brief fetches the next WIC_PACKET_ACK owed to the other end because no
+ *         header has carried the ack yet
+ *  \param target the target WicConnection
+ *  \param result the resulting ack packet
+ *  \return true if an ack is owed, false otherwise
+ */
+bool wic_connection_get_ack(WicConnection* target, WicPacket* result);
+/** \brief determines whether any reliable packets are still unacknowledged
+ *  \param target the target WicConnection
+ *  \return true if any are in flight, false otherwise
+ */
+bool wic_connection_has_unacked(WicConnection* target);
+#endif
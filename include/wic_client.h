@@ -22,6 +22,8 @@
 #ifndef WIC_CLIENT_H
 #define WIC_CLIENT_H
 #include "wic_packet.h"
+#include "wic_channel.h"
+#include "wic_profile.h"
 /** \brief a simple UDP client that connects to a server
  *  
  *  A WicClient works by sending and recieving packets to and from a server.
@@ -30,7 +32,8 @@
  *  packets out of a WicClient and processing them accordingly. Only
  *  one WicClient can be initialized at a time in a game.
  *  Since WicClient uses UDP, packets are likely, but not guaranteed, to arrive
- *  in order. Packets may not even arrive at all.
+ *  in order. Packets may not even arrive at all, unless they are sent over a
+ *  reliable channel.
  
  *  As a rule, the members of a WicClient should not be altered directly; they
  *  should be treated as read only.
@@ -61,18 +64,79 @@ bool wic_init_client(WicClient* target, char* name, unsigned server_port,
  */
 bool wic_client_join_server(WicClient* client, WicPacket* result,
                             double timeout);
+/** \brief sets whether or not a WicClient coalesces outgoing packets
+ *
+ *  While coalescing, sent packets are queued and packed into datagrams of up
+ *  to WIC_MAX_DATAGRAM_SIZE bytes. The queue is sent once it is full or when
+ *  wic_client_flush is called, typically once at the end of each tick.
+ *  Disabling coalescing flushes the queue.
+ *  \param target the target WicClient
+ *  \param coalescing whether or not to coalesce outgoing packets
+ *  \return true on success, false on failure
+ */
+bool wic_client_set_coalescing(WicClient* target, bool coalescing);
+/** \brief sends all queued packets of a coalescing WicClient
+ *  \param target the target WicClient
+ *  \return true on success, false on failure
+ */
+bool wic_client_flush(WicClient* target);
 /** \brief sends a packet to a client's server
  *  \param target the target WicClient
  *  \param packet the packet to send
  *  \return true on success, false on failure
  */
 bool wic_client_send_packet(WicClient* target, WicPacket* packet);
+/** \brief sends a packet to a client's server over a channel
+ *
+ *  Reliable packets are resent by wic_client_update_channels until they are
+ *  acknowledged; at most WIC_CHANNEL_WINDOW may be unacknowledged per channel.
+ *  \param target the target WicClient
+ *  \param packet the packet to send
+ *  \param channel the channel to send it over
+ *  \return true on success, false on failure
+ */
+bool wic_client_send_channel_packet(WicClient* target, WicPacket* packet,
+                                    enum WicChannel channel);
+/** \brief resends reliable packets whose acknowledgements are overdue and
+ *         acknowledges received reliable packets that nothing has
+ *         acknowledged yet
+ *
+ *  This should be called once per tick, before wic_client_flush.
+ *  \param target the target WicClient
+ *  \return true on success, false on failure
+ */
+bool wic_client_update_channels(WicClient* target);
+/** \brief returns the channel state of the connection to the server, e.g. to
+ *         read its round trip time
+ *  \param target the target WicClient
+ *  \return the connection on success, null on failure
+ */
+WicConnection* wic_client_get_connection(WicClient* target);
 /** \brief fetches and processes a single packet from the server
  *  \param target the target WicClient
  *  \param result the destination of the received packet
  *  \return true on success, false on failure
  */
 bool wic_client_recv_packet(WicClient* target, WicPacket* result);
+/** \brief blocks until a packet from the server is ready to be received
+ *
+ *  The socket is polled, so waiting uses no CPU and returns as soon as a
+ *  datagram arrives. Packets left over from an earlier coalesced datagram
+ *  count as ready.
+ *  \param target the target WicClient
+ *  \param timeout the maximum time to wait in seconds; negative waits forever
+ *  \return true if a packet is ready, false on timeout or failure
+ */
+bool wic_client_wait(WicClient* target, double timeout);
+/** \brief returns the file descriptor of a WicClient's socket
+ *
+ *  The descriptor can be registered in an external event loop. Once it is
+ *  readable, receive until wic_client_recv_packet returns false, since one
+ *  datagram may hold many packets.
+ *  \param target the target WicClient
+ *  \return the socket file descriptor on success, -1 on failure
+ */
+int wic_client_get_socket(WicClient* target);
 /** \brief leaves the server
  *  \param client the WicClient
  *  \return true on success, false on failure
@@ -22,7 +22,7 @@
 #ifndef WIC_COLOR_H
 #define WIC_COLOR_H
 #include <stdbool.h>
-#include "OpenGL/gl.h"
+#include "wic_gl.h"
 #include "wic_error.h"
 /** \brief an RGBA color
  *
@@ -81,6 +81,29 @@ typedef enum
     WIC_ERRNO_LARGE_NAME_OR_IP,
     WIC_ERRNO_UNBANNED_NAME_OR_IP,
     WIC_ERRNO_NO_SUCH_CLIENT,
+    WIC_ERRNO_SMALL_CAPACITY,
+    WIC_ERRNO_LARGE_DIMENSIONS,
+    WIC_ERRNO_THREAD_FAIL,
+    WIC_ERRNO_SMALL_BUDGET,
+    WIC_ERRNO_INVALID_FORMAT,
+    WIC_ERRNO_NULL_CALLBACK,
+    WIC_ERRNO_SMALL_TICK_RATE,
+    WIC_ERRNO_SMALL_MAX_TICKS,
+    WIC_ERRNO_WRITE_FILE_FAIL,
+    WIC_ERRNO_ALREADY_RECORDING,
+    WIC_ERRNO_NOT_RECORDING,
+    WIC_ERRNO_NOT_REPLAYING,
+    WIC_ERRNO_INVALID_LOG,
+    WIC_ERRNO_SHADER_FAIL,
+    WIC_ERRNO_MALFORMED_DATAGRAM,
+    WIC_ERRNO_INVALID_CHANNEL,
+    WIC_ERRNO_CHANNEL_FULL,
+    WIC_ERRNO_SMALL_ENTITY_SIZE,
+    WIC_ERRNO_LARGE_ENTITY_SIZE,
+    WIC_ERRNO_SMALL_NUM_ENTITIES,
+    WIC_ERRNO_LARGE_SNAPSHOT,
+    WIC_ERRNO_NULL_SERVER,
+    WIC_ERRNO_NULL_CLIENT,
 } WicError;
 extern WicError wic_errno;
 /** \brief translates the lastest wic_errno into a meaningful string and
@@ -27,12 +27,14 @@
 #include "wic_game.h"
 #include "wic_texture.h"
 #include "wic_image.h"
+#include "wic_atlas.h"
 #include "wic_error.h"
+#include "wic_jobs.h"
 /** \brief a font
  *
  *  A WicFont should be initialized via wic_init_font, which loads a font file
- *  to be used to draw text. A WicFont should eventually be deallocated via 
- *  wic_free_font.
+ *  to be used to draw text and rasterizes all of its glyphs into a single
+ *  texture. A WicFont should eventually be deallocated via wic_free_font.
  */
 typedef struct WicFont WicFont;
 /** \brief initializes a WicFont from a file
@@ -49,6 +51,17 @@ typedef struct WicFont WicFont;
  */
 WicFont* wic_init_font(const char* filepath, unsigned point, bool antialias,
                        WicGame* game);
+/** \brief fetches the amount of GPU memory a WicFont's glyphs occupy
+ *  \param target the target WicFont
+ *  \return the number of bytes of texture data on success, 0 on failure
+ */
+size_t wic_font_get_memory(WicFont* target);
+/** \brief fetches the amount of GPU memory a WicFont saves by storing its
+ *         glyphs with a single channel rather than as RGBA
+ *  \param target the target WicFont
+ *  \return the number of bytes saved on success, 0 on failure
+ */
+size_t wic_font_get_saved_memory(WicFont* target);
 /** \brief deallocates a WicFont
  *  \param target the target WicFont
  *  \return true on success, false on failure
@@ -21,17 +21,51 @@
 /** \file */
 #ifndef WIC_GAME_H
 #define WIC_GAME_H
+#include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
+#include <math.h>
+#include "wic_gl.h"
 #include "GLFW/glfw3.h"
 #include "FreeType/ft2build.h"
 #include FT_FREETYPE_H
 #include "wic_pair.h"
 #include "wic_error.h"
+#include "wic_profile.h"
+#include "wic_texture.h"
 extern const unsigned WIC_GAME_CONTINUE;
 extern const unsigned WIC_GAME_TERMINATE;
+/** \brief defines the OpenGL pipeline used to draw */
+enum WicBackend
+{
+    WIC_BACKEND_LEGACY, /**< the fixed-function pipeline of OpenGL 2.1 */
+    WIC_BACKEND_CORE    /**< a shader pipeline on an OpenGL 3.3 core profile
+                             context, recording every draw into a vertex 
+                             buffer that is drawn once per frame */
+};
+/** \brief defines how wic_updt_game waits for the next frame */
+enum WicPaceMode
+{
+    WIC_PACE_VSYNC,   /**< wait for the display's vertical sync only */
+    WIC_PACE_HYBRID,  /**< sleep until 2 ms before the frame, then spin */
+    WIC_PACE_ADAPTIVE /**< sleep for as long as the measured OS sleep 
+                           overshoot allows, then spin */
+};
+/** \brief summarizes the frame times measured by wic_updt_game
+ *
+ *  Frame times are binned into 0.1 ms buckets, so p99 is accurate to 0.1 ms
+ *  and is clamped at 100 ms.
+ */
+typedef struct WicFrameStats
+{
+    double min;          /**< the shortest frame time in seconds */
+    double mean;         /**< the mean frame time in seconds */
+    double p99;          /**< the 99th percentile frame time in seconds */
+    unsigned num_frames; /**< the number of frames measured */
+} WicFrameStats;
 /** \brief represents the entire  game
  *
  *  A WicGame should be initialized via wic_init_game. A WicGame should
@@ -48,19 +82,60 @@ typedef struct WicGame WicGame;
  *  \param fullscreen whether or not the game should run fullscreen
  *  \param samples the number of samples to use with antialiasing, a value of 0
  *         disables antialiasing
+ *  \param backend the OpenGL pipeline to draw with; the core backend also runs
+ *         on drivers that only expose core profiles, such as Mesa's llvmpipe
  *  \return a valid pointer to a WicGame on success, null on failure
  */
 WicGame* wic_init_game(const char* title, WicPair dimensions, unsigned fps,
-                       bool resizeable, bool fullscreen, unsigned samples);
+                       bool resizeable, bool fullscreen, unsigned samples,
+                       enum WicBackend backend);
 /** \brief flips the window buffers and times game updates
  *
  *  This function will wait a certain amount of time before returning, assuming
- *  there was no error, This mechanism ensures that the fps is maintained.
+ *  there was no error, This mechanism ensures that the fps is maintained. How
+ *  the wait is performed is set by wic_set_pace_mode.
  *  \return WIC_GAME_CONTINUE if the game should be updated, WIC_GAME_TERMINATE
  *          if the game should not be updated (for example when the window is 
  *          closed), 0 on failure
  */
 unsigned wic_updt_game(WicGame* target);
+/** \brief advances the simulation by one fixed tick
+ *  \param game the game
+ *  \param tick_time the length of the tick in seconds, which is always 
+ *         1 / tick_rate
+ *  \param data the user data given to wic_run_game
+ */
+typedef void (*WicTickCallback)(WicGame* game, double tick_time, void* data);
+/** \brief draws a frame
+ *  \param game the game
+ *  \param alpha how far the current time lies between the last tick and the
+ *         next, in [0, 1); state should be drawn interpolated by alpha between
+ *         its two most recent ticks
+ *  \param data the user data given to wic_run_game
+ */
+typedef void (*WicRenderCallback)(WicGame* game, double alpha, void* data);
+/** \brief runs the game with a fixed-timestep simulation until the window is
+ *         closed
+ *
+ *  Each frame, the time since the previous frame is added to an accumulator
+ *  and tick is called once for every whole tick it holds, so the simulation 
+ *  advances at tick_rate regardless of the frame rate. Under load, at most 
+ *  max_ticks ticks are run per frame and the remaining backlog is dropped, 
+ *  slowing the simulation rather than stalling the game. render is then 
+ *  called, followed by wic_updt_game. Key presses, characters, scrolling and
+ *  events are held until the next tick runs and are seen by that tick alone,
+ *  so input is neither lost in frames that run no ticks nor repeated by
+ *  catch-up ticks.
+ *  \param target the target WicGame
+ *  \param tick_rate the desired number of ticks per second; must be > 0
+ *  \param max_ticks the maximum number of ticks to run per frame; must be > 0
+ *  \param tick the function to call every tick; must be valid
+ *  \param render the function to call every frame; may be null
+ *  \param data user data to pass to tick and render
+ *  \return true once the window is closed, false on failure
+ */
+bool wic_run_game(WicGame* target, unsigned tick_rate, unsigned max_ticks,
+                  WicTickCallback tick, WicRenderCallback render, void* data);
 /** \brief closes the window
  *
  *  When this function is called, the window will be closed and updt_game will 
@@ -68,6 +143,51 @@ unsigned wic_updt_game(WicGame* target);
  *  \return true on success, false on failure
  */
 bool wic_exit_game(WicGame* target);
+/** \brief sets how wic_updt_game waits for the next frame
+ *
+ *  Games default to WIC_PACE_ADAPTIVE, which keeps frame times stable while 
+ *  spinning as little as the OS scheduler allows. WIC_PACE_HYBRID spins for a
+ *  fixed 2 ms, trading CPU time for accuracy on coarse schedulers. 
+ *  WIC_PACE_VSYNC leaves pacing to the display and burns no CPU time, but the
+ *  frame rate is then the display's refresh rate rather than the requested 
+ *  fps.
+ *  \param target the target WicGame
+ *  \param mode the desired pace mode
+ *  \return true on success, false on failure
+ */
+bool wic_set_pace_mode(WicGame* target, enum WicPaceMode mode);
+/** \brief moves rendering to a dedicated render thread
+ *
+ *  When enabled, the draw functions record their vertices into a frame packet
+ *  instead of calling GL, and wic_updt_game hands the packet to a render 
+ *  thread that owns the GL context, draws it, and swaps the window buffers. 
+ *  Two packets are double buffered, so the game can simulate and record the 
+ *  next frame while the previous one is drawn. Functions that create, update,
+ *  or free GPU resources keep working from the game thread: they run on the 
+ *  render thread while the game thread waits. The window, input, and every 
+ *  other wic function must still be used from the game thread only.
+ *  \param target the target WicGame
+ *  \param enabled whether or not rendering should happen on a render thread
+ *  \return true on success, false on failure
+ */
+bool wic_set_render_thread(WicGame* target, bool enabled);
+/** \brief fetches statistics on the frame times measured since the game was
+ *         initialized or since the last call to wic_reset_frame_stats
+ *  \param target the target WicGame
+ *  \return the frame time statistics on success, zeroed statistics on failure
+ */
+WicFrameStats wic_get_frame_stats(WicGame* target);
+/** \brief clears the measured frame times
+ *  \param target the target WicGame
+ *  \return true on success, false on failure
+ */
+bool wic_reset_frame_stats(WicGame* target);
+/** \brief fetches the number of draws skipped in the last frame because they
+ *         were entirely outside the window
+ *  \param target the target WicGame
+ *  \return the number of culled draws on success, 0 on failure
+ */
+unsigned wic_get_num_culled(WicGame* target);
 /** \brief fetches the time since the last update in seconds
  *  \return the time since the last update in seconds, -1 on failure
  */
@@ -209,6 +329,82 @@ enum WicKey
     WIC_MB_7 = 356,          /**< mouse button 7 */
     WIC_MB_8 = 357           /**< mouse button 8 */
 };
+/** \brief defines the types of input events */
+enum WicEventType
+{
+    WIC_EVENT_KEY_PRESS,   /**< a keyboard key/mouse button was pressed */
+    WIC_EVENT_KEY_REPEAT,  /**< a held keyboard key repeated */
+    WIC_EVENT_KEY_RELEASE, /**< a keyboard key/mouse button was released */
+    WIC_EVENT_CHAR,        /**< a character was typed */
+    WIC_EVENT_CURSOR,      /**< the cursor moved */
+    WIC_EVENT_SCROLL       /**< the scroll wheel/ball moved */
+};
+/** \brief a single timestamped input event */
+typedef struct WicEvent
+{
+    enum WicEventType type; /**< the type of the event */
+    double time;            /**< the time of the event in seconds, as given by
+                                 wic_get_time */
+    enum WicKey key;        /**< the keyboard key/mouse button of a key 
+                                 event */
+    uint32_t character;     /**< the UTF-32 code point of a char event */
+    WicPair pair;           /**< the new cursor location of a cursor event, 
+                                 measured in pixels from the lower-left corner
+                                 of the window, or the offset of a scroll 
+                                 event */
+} WicEvent;
+/** \brief retrieves the oldest input event received since the last game 
+ *         update and removes it from the event queue
+ *
+ *  Events are queued in the order they were received and remain available 
+ *  until the next call to wic_updt_game, which discards any that were not 
+ *  retrieved; under wic_run_game they instead remain until the end of the
+ *  next tick, as does the rest of the per-update input. Events are 
+ *  timestamped as the window system delivers them, during wic_updt_game. Up
+ *  to 1024 events are queued per update; later events are still reflected
+ *  by wic_is_key_down and the other input functions but are not queued.
+ *  \param result the destination of the event; must be valid
+ *  \return true if an event was retrieved, false if the queue is empty or on 
+ *          failure
+ */
+bool wic_poll_event(WicEvent* result);
+/** \brief starts recording input to a log file
+ *
+ *  Until wic_stop_recording is called, every input event and the clock of 
+ *  every game update are written to a compact binary log, which can be fed 
+ *  back through wic_start_replay. Logs can only be replayed on machines with
+ *  the same byte order.
+ *  \param filepath the filepath of the log to create; must be valid
+ *  \return true on success, false on failure
+ */
+bool wic_start_recording(const char* filepath);
+/** \brief stops recording input and closes the log file
+ *  \return true on success, false on failure
+ */
+bool wic_stop_recording();
+/** \brief starts replaying input from a log file
+ *
+ *  During a replay, input from the window system is ignored. Instead, each 
+ *  game update applies the input events recorded for it, so the input 
+ *  functions and wic_poll_event report exactly what they reported when the 
+ *  log was recorded. The frame clock is overridden as well: wic_get_delta and
+ *  wic_get_time return the recorded values, and wic_run_game ticks by them. 
+ *  The replay stops by itself at the end of the log.
+ *  \param filepath the filepath of the log to replay; must be valid
+ *  \param paced whether or not game updates should still be paced to the fps;
+ *         if false, updates run as fast as possible, which is useful for
+ *         benchmarking
+ *  \return true on success, false on failure
+ */
+bool wic_start_replay(const char* filepath, bool paced);
+/** \brief stops replaying input and closes the log file
+ *  \return true on success, false on failure
+ */
+bool wic_stop_replay();
+/** \brief determines whether or not input is being replayed
+ *  \return true if input is being replayed, false otherwise
+ */
+bool wic_is_replaying();
 /** \brief determines whether or not a keyboard key/mouse button is being
  *         depressed
  *  \param key ID of the keyboard key/mouse button
@@ -225,6 +421,9 @@ bool wic_is_key_down(enum WicKey key);
 bool wic_is_key_pressed(enum WicKey key);
 /** \brief retrieves the keyboard input (human-readable) since the last game
  *        update
+ *
+ *  Only the first 99 characters are kept, and characters outside of Latin-1
+ *  are omitted; use wic_poll_event to receive every character as UTF-32.
  *  \return a automatic unsigned char array of length 100, the input can be
  *         found at the beginning of the array, the rest of the array is filled
  *         with 0s
@@ -236,11 +435,14 @@ unsigned char* wic_get_input();
  *          of the window
  */
 WicPair wic_get_cursor_location(WicGame* game);
-/** \brief retrieves the scroll wheel/ball offset since the last game update
+/** \brief retrieves the total scroll wheel/ball offset since the last game 
+ *         update
  *  \return the scroll wheel/ball offset since the last game update
  */
 WicPair wic_get_scroll_offset();
 /** \brief retrieves the time since init_game was called
+ *
+ *  During a replay, the recorded time of the current game update is returned.
  *  \return the time since init_game was called in seconds
  */
 double wic_get_time();
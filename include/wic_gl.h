@@ -0,0 +1,37 @@
+/* ----------------------------------------------------------------------------
+ * wic - a simple 2D game engine for Mac OSX written in C
+ * Copyright (C) 2013-2017  Willis O'Leary
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * ----------------------------------------------------------------------------
+ * File:    wic_gl.h
+ * ----------------------------------------------------------------------------
+ */
+/** \file */
+#ifndef WIC_GL_H
+#define WIC_GL_H
+/* both the legacy (fixed-function) and the 3.3 core API are declared, since
+ * the backend is chosen at run time by wic_init_game */
+#if defined(__APPLE__)
+#define GL_DO_NOT_WARN_IF_MULTI_GL_VERSION_HEADERS_INCLUDED
+#include "OpenGL/gl.h"
+#include "OpenGL/gl3.h"
+#else
+#ifndef GL_GLEXT_PROTOTYPES
+#define GL_GLEXT_PROTOTYPES
+#endif
+#include "GL/gl.h"
+#include "GL/glext.h"
+#endif
+#endif
@@ -24,6 +24,7 @@
 #include "wic_pair.h"
 #include "wic_bounds.h"
 #include "wic_game.h"
+#include "wic_transform.h"
 #include "wic_texture.h"
 #include "wic_color.h"
 /** \brief an image that can be drawn to the screen
@@ -56,10 +57,40 @@ bool wic_init_image(WicImage* target, WicPair location, WicTexture* texture);
  */
 WicPair wic_image_get_geo_center(WicImage* target);
 /** \brief draws a WicImage to the screen
+ *
+ *  Nothing is drawn when the WicImage is entirely off screen.
  *  \param target the target WicImage
  *  \return true on success, false on failure
  */
 bool wic_draw_image(WicImage* target, WicGame* game);
+/** \brief draws an array of WicImages with one draw call per run of images
+ *         sharing a texture
+ *
+ *  The images are drawn in order, after everything drawn before the call, and
+ *  images whose textures are still loading are skipped. This is much faster
+ *  than calling wic_draw_image on each image when drawing thousands of them
+ *  per frame, and is instanced on the core backend.
+ *  \param targets the array of WicImages
+ *  \param num_targets the number of WicImages in the array
+ *  \param game the WicGame
+ *  \return true on success, false on failure
+ */
+bool wic_draw_images(WicImage* targets, unsigned num_targets, WicGame* game);
+/** \brief determines which WicImages in an array are at least partly on 
+ *         screen
+ *
+ *  wic_draw_image and wic_draw_images already skip WicImages that are entirely
+ *  off screen; this lets a game skip other per-object work as well. Rotated
+ *  WicImages are tested with a bounding circle, so a few WicImages near the
+ *  corners of the window may be reported visible when they are not.
+ *  \param targets the array of WicImages
+ *  \param num_targets the number of WicImages in the array
+ *  \param visible the array of num_targets flags to store the results in
+ *  \param game the WicGame
+ *  \return the number of visible WicImages on success, 0 on failure
+ */
+unsigned wic_cull_images(WicImage* targets, unsigned num_targets,
+                         bool* visible, WicGame* game);
 /** \brief deallocates a WicImage
  *  \param target the target WicImage
  *  \return true on success, false on failure
@@ -0,0 +1,120 @@
+/* ----------------------------------------------------------------------------
+ * wic - a simple 2D game engine for Mac OSX written in C
+ * Copyright (C) 2013-2017  Willis O'Leary
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * ----------------------------------------------------------------------------
+ * File:    wic_jobs.h
+ * ----------------------------------------------------------------------------
+ */
+/** \file */
+#ifndef WIC_JOBS_H
+#define WIC_JOBS_H
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include "wic_error.h"
+#include "wic_profile.h"
+/** \brief a function that performs one job
+ *  \param data the user data given to wic_submit_job
+ */
+typedef void (*WicJobFunction)(void* data);
+/** \brief a function that performs part of a wic_parallel_for
+ *  \param start the first index to process
+ *  \param end one past the last index to process
+ *  \param data the user data given to wic_parallel_for
+ */
+typedef void (*WicRangeFunction)(unsigned start, unsigned end, void* data);
+/** \brief tracks the completion of a group of jobs
+ *
+ *  A WicCounter should be initialized via wic_init_counter, passed to 
+ *  wic_submit_job along with each job of the group, and then waited on with
+ *  wic_wait_counter. A WicCounter must not be destroyed while it has 
+ *  unfinished jobs.
+ *
+ *  As a rule, the members of a WicCounter should not be altered directly; 
+ *  they should be treated as read only.
+ */
+typedef struct WicCounter
+{
+    unsigned pending; /**< the number of unfinished jobs */
+} WicCounter;
+/** \brief starts the worker threads of the job system
+ *
+ *  Calling this function is optional; the job system starts itself with the
+ *  default number of workers the first time a job is submitted. Each worker 
+ *  owns a work-stealing deque: jobs submitted from a worker are pushed onto its
+ *  own deque and run newest first, while idle workers steal the oldest jobs 
+ *  from the others. Jobs submitted from other threads go through a shared 
+ *  queue. Idle workers sleep rather than spin.
+ *  \param num_workers the desired number of worker threads, or 0 for one per
+ *         core beyond the first (at least one)
+ *  \return true on success, false on failure
+ */
+bool wic_init_jobs(unsigned num_workers);
+/** \brief fetches the number of worker threads, starting the job system if 
+ *         necessary
+ *  \return the number of worker threads on success, 0 on failure
+ */
+unsigned wic_get_num_workers();
+/** \brief initializes a WicCounter
+ *  \param target the target WicCounter
+ *  \return true on success, false on failure
+ */
+bool wic_init_counter(WicCounter* target);
+/** \brief submits a job to the job system
+ *
+ *  Jobs may be submitted from any thread, including from within other jobs.
+ *  \param function the function to run on a worker thread; must be valid
+ *  \param data user data to pass to function
+ *  \param counter the counter to track the job with; may be null
+ *  \return true on success, false on failure
+ */
+bool wic_submit_job(WicJobFunction function, void* data, WicCounter* counter);
+/** \brief determines whether or not every job tracked by a WicCounter has
+ *         finished
+ *  \param target the target WicCounter
+ *  \return true if every job has finished, false otherwise or on failure
+ */
+bool wic_is_counter_done(WicCounter* target);
+/** \brief waits until every job tracked by a WicCounter has finished
+ *
+ *  Rather than sleeping, the calling thread runs queued jobs while it waits, 
+ *  so waiting from the main thread adds it to the pool for the duration.
+ *  \param target the target WicCounter
+ *  \return true on success, false on failure
+ */
+bool wic_wait_counter(WicCounter* target);
+/** \brief calls a function on every index of a range in parallel and waits for
+ *         them to finish
+ *
+ *  The range is split into chunks of grain indices, which the workers and the
+ *  calling thread claim until none are left.
+ *  \param count the number of indices
+ *  \param grain the number of indices per chunk, or 0 to choose one 
+ *         automatically
+ *  \param function the function to call on each chunk; must be valid
+ *  \param data user data to pass to function
+ *  \return true on success, false on failure
+ */
+bool wic_parallel_for(unsigned count, unsigned grain,
+                      WicRangeFunction function, void* data);
+/** \brief stops the worker threads after every queued job has finished
+ *  \return true on success, false on failure
+ */
+bool wic_free_jobs();
+#endif
@@ -21,19 +21,28 @@
 /** \file include this file to gain access to the wic library */
 #ifndef WIC_LIB_H
 #define WIC_LIB_H
+#include "wic_atlas.h"
 #include "wic_bounds.h"
+#include "wic_camera.h"
+#include "wic_channel.h"
 #include "wic_client.h"
 #include "wic_color.h"
 #include "wic_error.h"
 #include "wic_font.h"
 #include "wic_game.h"
+#include "wic_gl.h"
 #include "wic_image.h"
+#include "wic_jobs.h"
 #include "wic_packet.h"
 #include "wic_pair.h"
 #include "wic_poly.h"
+#include "wic_profile.h"
 #include "wic_rect.h"
 #include "wic_server.h"
+#include "wic_snapshot.h"
 #include "wic_splash.h"
+#include "wic_sprite_batch.h"
 #include "wic_text.h"
 #include "wic_texture.h"
+#include "wic_transform.h"
 #endif
@@ -35,6 +35,7 @@
 #include <sys/socket.h>
 #include <errno.h>
 #include <unistd.h>
+#include <poll.h>
 #include "wic_error.h"
 /** \brief the maximum number of bytes alloted to any wic server or client name
  */
@@ -141,14 +142,63 @@ extern const uint8_t WIC_PACKET_CLIENT_LEFT_BANNED;
  *  This packet contains no data.
  */
 extern const WicPacketType WIC_PACKET_SERVER_SHUTDOWN;
+/** \brief the reserved packet that precedes a packet sent over a channel in
+ *         the same datagram
+ *
+ *  This packet contains 9 bytes of data. First, the channel, with the high bit
+ *  set if the ack fields are valid. Second, the 2 byte sequence number of the
+ *  following packet. Third, the 2 byte sequence number of the newest packet
+ *  received on the channel. Fourth, a 4 byte bitfield of which of the 32
+ *  packets before that one were received.
+ */
+extern const WicPacketType WIC_PACKET_CHANNEL;
+/** \brief the reserved packet acknowledging packets on a reliable channel
+ *         when there is no packet for the ack to ride along with
+ *
+ *  This packet contains 7 bytes of data: the channel and ack fields of
+ *  WIC_PACKET_CHANNEL.
+ */
+extern const WicPacketType WIC_PACKET_ACK;
+/** \brief the reserved packet carrying part of a world snapshot
+ *
+ *  This packet contains up to 255 bytes of data. First, the 2 byte sequence
+ *  number of the snapshot. Second, the 2 byte sequence number of its baseline.
+ *  Third, a byte that is 1 if the snapshot is a delta against the baseline and
+ *  0 if it is sent in full. Fourth, the index of this packet within the
+ *  snapshot. Fifth, the number of packets in the snapshot. The rest is changed
+ *  entities, each a 2 byte entity index followed by the entity's bytes.
+ */
+extern const WicPacketType WIC_PACKET_SNAPSHOT;
+/** \brief the reserved packet a client sends to acknowledge a snapshot
+ *
+ *  This packet contains 3 bytes of data. First, the 2 byte sequence number of
+ *  the newest complete snapshot. Second, a byte that is 1 if the snapshot was
+ *  rebuilt, or 0 if its baseline was missing and a full snapshot is needed.
+ */
+extern const WicPacketType WIC_PACKET_SNAPSHOT_ACK;
 /** \brief the size of the packet header */
 extern const size_t WIC_PACKET_HEADER_SIZE;
+/** \brief the maximum size of a datagram of coalesced packets
+ *
+ *  This is kept below the common ethernet MTU so coalesced datagrams are not
+ *  fragmented along the way.
+ */
+extern const size_t WIC_MAX_DATAGRAM_SIZE;
 /** \brief parses a packet from a given buffer 
  *  \param buffer a buffer with enough spcae to store the entire WicPacket
  *  \param result the resulting packet
  *  \return true on success, false on failure
  */
 bool wic_get_packet_from_buffer(uint8_t* buffer, WicPacket* result);
+/** \brief parses the next packet from a datagram of coalesced packets
+ *  \param datagram the received datagram
+ *  \param len_datagram the length of the datagram in bytes
+ *  \param offset the offset of the next packet; advanced past the packet
+ *  \param result the resulting packet
+ *  \return true on success, false on failure
+ */
+bool wic_get_packet_from_datagram(uint8_t* datagram, size_t len_datagram,
+                                  size_t* offset, WicPacket* result);
 /** \brief copies packet data into a buffer
  *
  *  \param result a buffer with enough space to store the entire WicPacket
@@ -156,6 +206,12 @@ bool wic_get_packet_from_buffer(uint8_t* buffer, WicPacket* result);
  *  \return true on success, false on failure
  */
 bool wic_convert_packet_to_buffer(uint8_t* result, WicPacket* packet);
+/** \brief blocks until a socket is readable
+ *  \param socket the socket file descriptor
+ *  \param timeout the maximum time to wait in seconds; negative waits forever
+ *  \return true if the socket is readable, false on timeout or failure
+ */
+bool wic_wait_socket(int socket, double timeout);
 /** \brief determines whether or not a packet id is reserved
  *  \return whether or not the packet id is reserved by wic
  */
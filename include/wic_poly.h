@@ -24,10 +24,15 @@
 #include "wic_pair.h"
 #include "wic_color.h"
 #include "wic_game.h"
+#include "wic_transform.h"
 /** \brief a filled polygon that can be drawn to the screen
  *
- *  A WicPoly should be initialized via wic_init_poly. A WicPoly should
- *  eventually be deallocated via wic_free_poly.
+ *  The polygon may be concave. It is triangulated once when initialized, and
+ *  the triangles are kept in a GPU vertex buffer from the first draw on, so
+ *  drawing only sends the transform. Changing vertices after initialization
+ *  does not change what is drawn. A WicPoly should be initialized via
+ *  wic_init_poly. A WicPoly should eventually be deallocated via
+ *  wic_free_poly.
  */
 typedef struct WicPoly
 {
@@ -41,12 +46,18 @@ typedef struct WicPoly
     WicPair* vertices;       /**< the set of vertices in clockwise or 
                               *   counter-clockwise order */
     unsigned num_vertices;   /**< the number of vertices */
+    WicPair* triangles;      /**< the triangulation of vertices, three per
+                              *   triangle */
+    unsigned buffer;         /**< the GPU vertex buffer of triangles; 0 until
+                              *   first drawn */
+    WicBounds bounds;        /**< the bounding box of vertices */
 } WicPoly;
 /** \brief initializes a WicPoly
  *  \param target the target WicPoly
  *  \param location the desired screen location
  *  \param vertices pointer to the the desired vertices (relative to the 
- *         object), in clockwise or counterclockwise order
+ *         object), in clockwise or counterclockwise order; the polygon may
+ *         be concave but should not intersect itself
  *  \param num_vertices the number of elements in vertices; must be > 2; an
  *         incorrect value will result in undefined behavior
  *  \param color the desired color
@@ -60,6 +71,8 @@ bool wic_init_poly(WicPoly* target, WicPair location, WicPair* vertices,
  */
 WicPair wic_poly_get_geo_center(WicPoly* target);
 /** \brief draws a WicPoly
+ *
+ *  Nothing is drawn when the WicPoly is entirely off screen.
  *  \param poly the target WicPoly
  *  \param game the WicGame
  *  \return true on success, false on failure
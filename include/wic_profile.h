@@ -0,0 +1,83 @@
+/* ----------------------------------------------------------------------------
+ * wic - a simple 2D game engine for Mac OSX written in C
+ * Copyright (C) 2013-2017  Willis O'Leary
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * ----------------------------------------------------------------------------
+ * File:    wic_profile.h
+ * ----------------------------------------------------------------------------
+ */
+/** \file */
+#ifndef WIC_PROFILE_H
+#define WIC_PROFILE_H
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+#include "wic_error.h"
+/** \brief marks the beginning of a profiled zone
+ *
+ *  Zones are recorded only when wic is compiled with WIC_PROFILE defined; 
+ *  otherwise this macro, along with the other WIC_PROFILE macros, expands to 
+ *  nothing and its arguments are not evaluated. Every WIC_PROFILE_BEGIN must 
+ *  be matched by a WIC_PROFILE_END with the same name on the same thread.
+ *  \param name the name of the zone; must be a string literal or otherwise
+ *         outlive the profiler
+ */
+#ifdef WIC_PROFILE
+#define WIC_PROFILE_BEGIN(name) wic_profile_begin(name)
+#define WIC_PROFILE_END(name) wic_profile_end(name)
+#define WIC_PROFILE_COUNT(name, value) wic_profile_count(name, value)
+#define WIC_PROFILE_FRAME() wic_profile_frame()
+#else
+#define WIC_PROFILE_BEGIN(name) ((void) 0)
+#define WIC_PROFILE_END(name) ((void) 0)
+#define WIC_PROFILE_COUNT(name, value) ((void) 0)
+#define WIC_PROFILE_FRAME() ((void) 0)
+#endif
+/** \brief records the beginning of a zone on the calling thread
+ *
+ *  Each thread records into its own ring buffer, which holds the most recent 
+ *  65536 events; no locks are taken. Prefer the WIC_PROFILE_BEGIN macro, 
+ *  which compiles to nothing unless WIC_PROFILE is defined.
+ *  \param name the name of the zone; must be a string literal or otherwise
+ *         outlive the profiler
+ */
+void wic_profile_begin(const char* name);
+/** \brief records the end of a zone on the calling thread
+ *  \param name the name of the zone, identical to the name given to the
+ *         matching wic_profile_begin
+ */
+void wic_profile_end(const char* name);
+/** \brief records the value of a counter on the calling thread
+ *  \param name the name of the counter; must be a string literal or otherwise
+ *         outlive the profiler
+ *  \param value the value of the counter
+ */
+void wic_profile_count(const char* name, double value);
+/** \brief marks the beginning of a new frame on the calling thread */
+void wic_profile_frame();
+/** \brief writes every recorded event to a Chrome trace file
+ *
+ *  The file can be opened in Chrome's about:tracing or in Perfetto. Threads
+ *  may continue to record while the trace is written; events they overwrite
+ *  in the meantime are omitted.
+ *  \param filepath the filepath of the trace file to create; must be valid
+ *  \return true on success, false on failure
+ */
+bool wic_profile_write_trace(const char* filepath);
+/** \brief discards every recorded event */
+void wic_profile_clear();
+#endif
@@ -24,6 +24,7 @@
 #include "wic_pair.h"
 #include "wic_color.h"
 #include "wic_game.h"
+#include "wic_transform.h"
 /**  \brief a filled rectangle that can be drawn to the screen
  *
  *  A WicRect should be initialized via wic_init_rect.
@@ -54,9 +55,36 @@ bool wic_init_rect(WicRect* target, WicPair location, WicPair dimensions,
  */
 WicPair wic_rect_get_geo_center(WicRect* target);
 /** \brief draws a WicRect
+ *
+ *  Nothing is drawn when the WicRect is entirely off screen.
  *  \param target the target WicRect
  *  \param game the WicGame
  *  \return true on success, false otherwise
  */
 bool wic_draw_rect(WicRect* target, WicGame* game);
+/** \brief draws an array of WicRects with a single draw call
+ *
+ *  The rects are drawn in order, after everything drawn before the call. This
+ *  is much faster than calling wic_draw_rect on each rect when drawing
+ *  thousands of them per frame, and is instanced on the core backend.
+ *  \param targets the array of WicRects
+ *  \param num_targets the number of WicRects in the array
+ *  \param game the WicGame
+ *  \return true on success, false otherwise
+ */
+bool wic_draw_rects(WicRect* targets, unsigned num_targets, WicGame* game);
+/** \brief determines which WicRects in an array are at least partly on screen
+ *
+ *  wic_draw_rect and wic_draw_rects already skip WicRects that are entirely
+ *  off screen; this lets a game skip other per-object work as well. Rotated
+ *  WicRects are tested with a bounding circle, so a few WicRects near the
+ *  corners of the window may be reported visible when they are not.
+ *  \param targets the array of WicRects
+ *  \param num_targets the number of WicRects in the array
+ *  \param visible the array of num_targets flags to store the results in
+ *  \param game the WicGame
+ *  \return the number of visible WicRects on success, 0 on failure
+ */
+unsigned wic_cull_rects(WicRect* targets, unsigned num_targets, bool* visible,
+                        WicGame* game);
 #endif
@@ -22,7 +22,9 @@
 #ifndef WIC_SERVER_H
 #define WIC_SERVER_H
 #include "wic_error.h"
+#include "wic_profile.h"
 #include "wic_packet.h"
+#include "wic_channel.h"
 /** \brief a simple UDP server that connects to multiple clients
  *
  *  A WicServer works by sending and recieving packets to and from players.
@@ -32,7 +34,9 @@
  *  Only one WicServer can be initialized at a time. 
  *
  *  Since WicServer uses UDP, packets are likely, but not guaranteed, to arrive
- *  in order. Packets may not even arrive at all.
+ *  in order. Packets may not even arrive at all, unless they are sent over a
+ *  reliable channel. Announcements of joining and leaving clients, kicks, and
+ *  bans are sent over the reliable ordered channel.
  *
  * As a rule, the members of a WicServer should not be altered directly; they
  * should be treated as read only.
@@ -57,6 +61,22 @@ typedef struct WicServer
  */
 bool wic_init_server(WicServer* target, char* name, unsigned port,
                      uint8_t max_clients);
+/** \brief sets whether or not a WicServer coalesces outgoing packets
+ *
+ *  While coalescing, sent packets are queued per client and packed into
+ *  datagrams of up to WIC_MAX_DATAGRAM_SIZE bytes. A queue is sent once it is
+ *  full or when wic_server_flush is called, typically once at the end of each
+ *  tick. Disabling coalescing flushes all queues.
+ *  \param target the target WicServer
+ *  \param coalescing whether or not to coalesce outgoing packets
+ *  \return true on success, false on failure
+ */
+bool wic_server_set_coalescing(WicServer* target, bool coalescing);
+/** \brief sends all queued packets of a coalescing WicServer
+ *  \param target the target WicServer
+ *  \return true on success, false on failure
+ */
+bool wic_server_flush(WicServer* target);
 /** \brief sends a single packet to a client
  *  \param server the WicServer
  *  \param packet the packet to send
@@ -65,6 +85,37 @@ bool wic_init_server(WicServer* target, char* name, unsigned port,
  */
 bool wic_server_send_packet(WicServer* target, WicPacket* packet,
                             WicNodeIndex dest_index);
+/** \brief sends a single packet to a client over a channel
+ *
+ *  Reliable packets are resent by wic_server_update_channels until they are
+ *  acknowledged; at most WIC_CHANNEL_WINDOW may be unacknowledged per client
+ *  and channel.
+ *  \param target the target WicServer
+ *  \param packet the packet to send
+ *  \param dest_index the index of the client to sent it to; must be > 0
+ *  \param channel the channel to send it over
+ *  \return true on success, false on failure
+ */
+bool wic_server_send_channel_packet(WicServer* target, WicPacket* packet,
+                                    WicNodeIndex dest_index,
+                                    enum WicChannel channel);
+/** \brief resends reliable packets whose acknowledgements are overdue and
+ *         acknowledges received reliable packets that nothing has
+ *         acknowledged yet
+ *
+ *  This should be called once per tick, before wic_server_flush.
+ *  \param target the target WicServer
+ *  \return true on success, false on failure
+ */
+bool wic_server_update_channels(WicServer* target);
+/** \brief returns the channel state of a client's connection, e.g. to read
+ *         its round trip time
+ *  \param target the target WicServer
+ *  \param client_index the client's index; must be > 0
+ *  \return the connection on success, null on failure
+ */
+WicConnection* wic_server_get_connection(WicServer* target,
+                                         WicNodeIndex client_index);
 /** \brief sends a packet to all connected clients but one
  *  \param target the target WicServer
  *  \param packet the packet to send
@@ -85,6 +136,37 @@ bool wic_server_send_packet_all(WicServer* target, WicPacket* packet);
  *  \return true on success, false on failure
  */
 bool wic_server_recv_packet(WicServer* target, WicPacket* result);
+/** \brief fetches and processes as many packets from clients as are waiting,
+ *         up to a maximum
+ *
+ *  On Linux, waiting datagrams are drained in batches with a single syscall
+ *  each, so this is the cheapest way to empty the socket once per tick.
+ *  \param target the target WicServer
+ *  \param results the destination array of the received packets
+ *  \param max_results the capacity of results
+ *  \return the number of packets received
+ */
+unsigned wic_server_recv_packets(WicServer* target, WicPacket* results,
+                                 unsigned max_results);
+/** \brief blocks until a packet from a client is ready to be received
+ *
+ *  The socket is polled, so waiting uses no CPU and returns as soon as a
+ *  datagram arrives. Packets left over from an earlier coalesced datagram or
+ *  batch count as ready.
+ *  \param target the target WicServer
+ *  \param timeout the maximum time to wait in seconds; negative waits forever
+ *  \return true if a packet is ready, false on timeout or failure
+ */
+bool wic_server_wait(WicServer* target, double timeout);
+/** \brief returns the file descriptor of a WicServer's socket
+ *
+ *  The descriptor can be registered in an external event loop. Once it is
+ *  readable, receive until wic_server_recv_packet returns false, since one
+ *  datagram may hold many packets.
+ *  \param target the target WicServer
+ *  \return the socket file descriptor on success, -1 on failure
+ */
+int wic_server_get_socket(WicServer* target);
 /** \brief kicks a client
  *  \param target the target WicServer
  *  \param client_index the client's index; must be > 0
@@ -0,0 +1,134 @@
+/* ----------------------------------------------------------------------------
+ * wic - a simple 2D game engine for Mac OSX written in C
+ * Copyright (C) 2013-2017  Willis O'Leary
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * ----------------------------------------------------------------------------
+ * File:    wic_snapshot.h
+ * ----------------------------------------------------------------------------
+ */
+/** \file */
+#ifndef WIC_SNAPSHOT_H
+#define WIC_SNAPSHOT_H
+#include <stdbool.h>
+#include <stdint.h>
+#include "wic_error.h"
+#include "wic_profile.h"
+#include "wic_packet.h"
+#include "wic_server.h"
+#include "wic_client.h"
+/** \brief the number of past snapshots kept to serve as baselines */
+#define WIC_SNAPSHOT_HISTORY 32
+/** \brief a short history of world snapshots kept by a server or a client
+ *
+ *  A snapshot is the state of a fixed number of fixed size entities laid out
+ *  back to back, in whatever format the game chooses. The server sends each
+ *  client only the entities that changed since the last snapshot that client
+ *  acknowledged, so mostly static worlds cost little bandwidth per tick. The
+ *  client rebuilds the full state from its copy of that baseline. Snapshots
+ *  are sent unreliably; a lost one is simply superseded by the next.
+ *
+ *  A WicSnapshots is initialized via wic_init_server_snapshots on a server
+ *  and via wic_init_client_snapshots on a client, with matching entity sizes
+ *  and counts. As a rule, the members of a WicSnapshots should not be altered
+ *  directly; they should be treated as read only.
+ */
+typedef struct WicSnapshots
+{
+    uint16_t entity_size;                   /**< the bytes per entity */
+    uint16_t num_entities;                  /**< the entities per snapshot */
+    uint8_t* states;                        /**< the snapshot history */
+    uint16_t seqs[WIC_SNAPSHOT_HISTORY];    /**< the sequence number of each */
+    bool valid[WIC_SNAPSHOT_HISTORY];       /**< whether each is valid */
+    uint16_t next_seq;                      /**< the next sequence number */
+    uint8_t max_nodes;                      /**< the server's max_nodes */
+    bool* acked;                            /**< whether each client has
+                                             *   acknowledged a snapshot */
+    uint16_t* acked_seqs;                   /**< the newest snapshot each
+                                             *   client acknowledged */
+    WicPacket* fragments;                   /**< the packets of one delta */
+    bool has_latest;                        /**< whether latest_seq is valid */
+    uint16_t latest_seq;                    /**< the newest complete snapshot
+                                             *   a client received */
+    uint8_t* pending;                       /**< the snapshot being rebuilt */
+    bool assembling;                        /**< whether pending is in use */
+    bool broken;                            /**< whether pending's baseline
+                                             *   is missing */
+    uint16_t pending_seq;                   /**< pending's sequence number */
+    uint8_t num_fragments;                  /**< pending's packet count */
+    uint8_t num_received;                   /**< pending's packets received */
+    bool received[256];                     /**< which of pending's packets
+                                             *   were received */
+} WicSnapshots;
+/** \brief initializes a WicSnapshots for sending snapshots from a server
+ *  \param target the target WicSnapshots
+ *  \param server the WicServer
+ *  \param entity_size the bytes per entity; must be in the range 1-246
+ *  \param num_entities the entities per snapshot; must be > 0 and small
+ *         enough for a full snapshot to fit in 255 packets
+ *  \return true on success, false on failure
+ */
+bool wic_init_server_snapshots(WicSnapshots* target, WicServer* server,
+                               uint16_t entity_size, uint16_t num_entities);
+/** \brief initializes a WicSnapshots for receiving snapshots on a client
+ *  \param target the target WicSnapshots
+ *  \param entity_size the bytes per entity; must match the server's
+ *  \param num_entities the entities per snapshot; must match the server's
+ *  \return true on success, false on failure
+ */
+bool wic_init_client_snapshots(WicSnapshots* target, uint16_t entity_size,
+                               uint16_t num_entities);
+/** \brief records a snapshot and sends every joined client the entities that
+ *         changed since the last snapshot it acknowledged
+ *
+ *  This is typically called once per tick, in place of broadcasting the full
+ *  state. Clients that acknowledged the same snapshot share one encoding.
+ *  \param server the WicServer
+ *  \param target the target WicSnapshots
+ *  \param state the snapshot; num_entities * entity_size bytes
+ *  \return true on success, false on failure
+ */
+bool wic_server_send_snapshot(WicServer* server, WicSnapshots* target,
+                              void* state);
+/** \brief processes a packet received by a server for snapshot
+ *         acknowledgements
+ *
+ *  Every packet returned by wic_server_recv_packet should be passed here so
+ *  acknowledgements are recorded and newly joined clients get a full
+ *  snapshot.
+ *  \param target the target WicSnapshots
+ *  \param packet the received packet
+ *  \return true if the packet was a snapshot acknowledgement, false otherwise
+ */
+bool wic_server_process_snapshot_ack(WicSnapshots* target, WicPacket* packet);
+/** \brief processes a packet received by a client, rebuilding the newest
+ *         snapshot once all of its packets have arrived
+ *
+ *  Every packet returned by wic_client_recv_packet should be passed here.
+ *  Complete snapshots are acknowledged to the server automatically.
+ *  \param client the WicClient
+ *  \param target the target WicSnapshots
+ *  \param packet the received packet
+ *  \param result the destination of a newly completed snapshot;
+ *         num_entities * entity_size bytes
+ *  \return true if a newer snapshot was completed, false otherwise
+ */
+bool wic_client_process_snapshot(WicClient* client, WicSnapshots* target,
+                                 WicPacket* packet, void* result);
+/** \brief frees a WicSnapshots
+ *  \param target the target WicSnapshots
+ *  \return true on success, false on failure
+ */
+bool wic_free_snapshots(WicSnapshots* target);
+#endif
@@ -0,0 +1,102 @@
+/* ----------------------------------------------------------------------------
+ * wic - a simple 2D game engine for Mac OSX written in C
+ * Copyright (C) 2013-2017  Willis O'Leary
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * ----------------------------------------------------------------------------
+ * File:    wic_sprite_batch.h
+ * ----------------------------------------------------------------------------
+ */
+/** \file */
+#ifndef WIC_SPRITE_BATCH_H
+#define WIC_SPRITE_BATCH_H
+#include <stdlib.h>
+#include "wic_error.h"
+#include "wic_game.h"
+#include "wic_image.h"
+#include "wic_jobs.h"
+/** \brief a set of WicImages that are drawn to the screen together
+ *
+ *  A WicSpriteBatch gathers the quads of many WicImages into a single vertex
+ *  array and draws them with one draw call per run of images that share a 
+ *  WicTexture. Images are drawn in the order they were added and look exactly
+ *  as they would if drawn with wic_draw_image. A WicSpriteBatch should be 
+ *  initialized via wic_init_sprite_batch. A WicSpriteBatch should eventually 
+ *  be deallocated via wic_free_sprite_batch.
+ */
+typedef struct WicSpriteBatch WicSpriteBatch;
+/** \brief initializes a WicSpriteBatch
+ *  \param capacity the number of images the batch can hold before it must be 
+ *         drawn; must be > 0
+ *  \return a valid pointer to a WicSpriteBatch on success, null on failure
+ */
+WicSpriteBatch* wic_init_sprite_batch(unsigned capacity);
+/** \brief adds a WicImage to a WicSpriteBatch
+ *
+ *  If the batch is already full, its contents are drawn before the image is 
+ *  added.
+ *  \param target the target WicSpriteBatch
+ *  \param image the WicImage to add; the image is copied, so it can be altered
+ *         or discarded immediately
+ *  \param game the game
+ *  \return true on success, false on failure
+ */
+bool wic_sprite_batch_add_image(WicSpriteBatch* target, WicImage* image,
+                                WicGame* game);
+/** \brief adds an array of WicImages to a WicSpriteBatch
+ *
+ *  This is equivalent to calling wic_sprite_batch_add_image on each image in
+ *  order, except that the quads of large arrays are computed in parallel on 
+ *  the job system. If the batch fills up, its contents are drawn before the 
+ *  rest of the images are added.
+ *  \param target the target WicSpriteBatch
+ *  \param images the WicImages to add; every image must have a valid texture;
+ *         the images are copied, so they can be altered or discarded 
+ *         immediately
+ *  \param num_images the number of images
+ *  \param game the game
+ *  \return true on success, false on failure
+ */
+bool wic_sprite_batch_add_images(WicSpriteBatch* target, WicImage* images,
+                                 unsigned num_images, WicGame* game);
+/** \brief draws and empties a WicSpriteBatch
+ *  \param target the target WicSpriteBatch
+ *  \return true on success, false on failure
+ */
+bool wic_draw_sprite_batch(WicSpriteBatch* target);
+/** \brief fetches the number of draw calls a WicSpriteBatch has issued
+ *  \param target the target WicSpriteBatch
+ *  \return the number of draw calls issued since initialization or the last
+ *          call to wic_sprite_batch_reset_stats, 0 on failure
+ */
+unsigned wic_sprite_batch_get_draws(WicSpriteBatch* target);
+/** \brief fetches the number of draw calls a WicSpriteBatch has saved
+ *  \param target the target WicSpriteBatch
+ *  \return the number of draw calls that drawing each image with 
+ *          wic_draw_image would have issued, minus the number of draw calls
+ *          actually issued, since initialization or the last call to
+ *          wic_sprite_batch_reset_stats, 0 on failure
+ */
+unsigned wic_sprite_batch_get_saved_draws(WicSpriteBatch* target);
+/** \brief resets the draw call statistics of a WicSpriteBatch
+ *  \param target the target WicSpriteBatch
+ *  \return true on success, false on failure
+ */
+bool wic_sprite_batch_reset_stats(WicSpriteBatch* target);
+/** \brief deallocates a WicSpriteBatch
+ *  \param target the target WicSpriteBatch
+ *  \return true on success, false on failure
+ */
+bool wic_free_sprite_batch(WicSpriteBatch* target);
+#endif
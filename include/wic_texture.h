@@ -22,10 +22,17 @@
 #ifndef WIC_TEXTURE_H
 #define WIC_TEXTURE_H
 #include "stdlib.h"
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
 #include "wic_pair.h"
 #include "wic_error.h"
+#include "wic_jobs.h"
+#include "wic_profile.h"
 #include "SOIL/SOIL.h"
-#include "OpenGL/gl.h"
+#include "wic_gl.h"
+#include "GLFW/glfw3.h"
 /** \brief defines constants for texture filtering (behavior when images are
  *         scaled beyond or below their resolution)
  */
@@ -58,6 +65,14 @@ enum WicWrap
                                            *   texture dimensions
                                            */
 };
+/** \brief defines constants for the loading status of a texture
+ */
+enum WicTextureStatus
+{
+    WIC_TEXTURE_LOADING, /**< the texture is still being loaded */
+    WIC_TEXTURE_READY,   /**< the texture is loaded and can be drawn */
+    WIC_TEXTURE_FAILED   /**< the texture failed to load or was freed */
+};
 /** \brief a texture
  * 
  *  A WicTexture should be initialized via wic_init_texture_from_buffer or
@@ -94,6 +109,64 @@ WicTexture* wic_init_texture_from_buffer(unsigned char* buffer,
  */
 WicTexture* wic_init_texture_from_file(char* filepath, enum WicFilter filter,
                                        enum WicWrap wrap);
+/** \brief called when an asynchronously loaded texture finishes loading
+ *  \param texture the texture
+ *  \param success whether or not the texture loaded successfully
+ *  \param data the user data given to wic_init_texture_from_file_async
+ */
+typedef void (*WicTextureCallback)(WicTexture* texture, bool success,
+                                   void* data);
+/** \brief initializes a WicTexture from a file without blocking
+ *
+ *  The file is decoded by a job (see wic_jobs.h) and uploaded to the GPU during
+ *  a later call to wic_updt_textures (which wic_updt_game makes once per 
+ *  frame). Until then, the WicTexture has dimensions of (0, 0) and images 
+ *  using it are not drawn, so WicImages should be initialized with it only
+ *  once it is ready.
+ *  \param filepath the absolute or relative filepath to a non-1bpp and non-RLE 
+ *         BMP, non-interlaced PNG, JPEG, TGA, DDS, PSD, or HDR image file
+ *  \param filter the desired texture filter (defines behavior when textures are
+ *          scaled beyond or below their resolution
+ *  \param wrap the texture wrap (defines behavior when drawing outside texture
+ *         dimensions
+ *  \param callback the function to call on the main thread when loading
+ *         completes or fails; may be null
+ *  \param data user data to pass to callback
+ *  \return a valid pointer to a loading WicTexture on success, null on failure
+ */
+WicTexture* wic_init_texture_from_file_async(char* filepath,
+                                             enum WicFilter filter,
+                                             enum WicWrap wrap,
+                                             WicTextureCallback callback,
+                                             void* data);
+/** \brief uploads asynchronously loaded textures that have finished decoding
+ *
+ *  Uploads continue until none are left or the upload budget is spent, but at
+ *  least one upload is made if any are waiting. This function must be called
+ *  from the thread that owns the GL context; wic_updt_game calls it
+ *  automatically.
+ *  \return the number of textures that finished loading
+ */
+unsigned wic_updt_textures();
+/** \brief sets how much time wic_updt_textures may spend uploading each call
+ *  \param budget the budget in seconds; must be >= 0; the default is 0.002
+ *  \return true on success, false on failure
+ */
+bool wic_set_texture_upload_budget(double budget);
+/** \brief fetches the loading status of a WicTexture
+ *  \param target the target WicTexture
+ *  \return the loading status on success, WIC_TEXTURE_FAILED on failure
+ */
+enum WicTextureStatus wic_texture_get_status(WicTexture* target);
+/** \brief fetches the amount of GPU memory a WicTexture occupies
+ *
+ *  Textures initialized from WIC_MONO or WIC_GREYSCALE buffers are stored with
+ *  a single channel per pixel, so they occupy a quarter of the memory of RGB 
+ *  and RGBA textures of the same dimensions.
+ *  \param target the target WicTexture
+ *  \return the number of bytes of texture data on success, 0 on failure
+ */
+size_t wic_texture_get_memory(WicTexture* target);
 /** \brief returns the dimensions of a texture.
  *  \param target the target WicTexture
  *  \return the dimensons of target on success, (-1, -1) on failure.
@@ -0,0 +1,115 @@
+/* ----------------------------------------------------------------------------
+ * wic - a simple 2D game engine for Mac OSX written in C
+ * Copyright (C) 2013-2017  Willis O'Leary
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * ----------------------------------------------------------------------------
+ * File:    wic_transform.h
+ * ----------------------------------------------------------------------------
+ */
+/** \file */
+#ifndef WIC_TRANSFORM_H
+#define WIC_TRANSFORM_H
+#include <stdbool.h>
+#include <math.h>
+#include "wic_pair.h"
+#include "wic_bounds.h"
+/** \brief a 2D affine transform
+ *
+ *  A WicTransform maps a WicPair (x, y) to (a*x + c*y + tx, b*x + d*y + ty).
+ *  Building a WicTransform computes the sine and cosine of its rotation once, 
+ *  so transforming many WicPairs with it is cheaper than calling 
+ *  wic_transform_pair on each of them. A WicTransform should be initialized 
+ *  via wic_get_transform or wic_get_window_transform.
+ */
+typedef struct WicTransform
+{
+    double a;  /**< the x component of the transformed x-axis */
+    double b;  /**< the y component of the transformed x-axis */
+    double c;  /**< the x component of the transformed y-axis */
+    double d;  /**< the y component of the transformed y-axis */
+    double tx; /**< the x component of the translation */
+    double ty; /**< the y component of the translation */
+} WicTransform;
+/** \brief builds the transform of a drawable
+ *
+ *  The resulting transform scales and rotates around center, then translates
+ *  by location (and by center, unless draw_centered is true), exactly as 
+ *  WicImages, WicRects, and WicPolys are drawn.
+ *  \param location the location
+ *  \param center the center to scale, rotate, or draw around
+ *  \param rotation the rotation measured in radians from the positive x-axis
+ *  \param scale the scale
+ *  \param draw_centered whether or not to draw around the center
+ *  \return the transform
+ */
+WicTransform wic_get_transform(WicPair location, WicPair center,
+                               double rotation, WicPair scale,
+                               bool draw_centered);
+/** \brief computes screen bounds that contain a drawable
+ *
+ *  The bounds are exact when rotation is 0. Otherwise they contain the circle
+ *  the drawable sweeps around its center, which is cheaper to compute than 
+ *  the rotated corners and is enough to tell whether or not it is on screen.
+ *  \param location the location
+ *  \param center the center to scale, rotate, or draw around
+ *  \param rotation the rotation measured in radians from the positive x-axis
+ *  \param scale the scale
+ *  \param draw_centered whether or not to draw around the center
+ *  \param bounds the bounds of the drawable before it is transformed
+ *  \return the screen bounds
+ */
+WicBounds wic_get_drawable_bounds(WicPair location, WicPair center,
+                                  double rotation, WicPair scale,
+                                  bool draw_centered, WicBounds bounds);
+/** \brief builds the transform from window coordinates to the normalized
+ *         coordinates OpenGL draws with
+ *  \param window_dimensions the dimensions of the window
+ *  \return the transform
+ */
+WicTransform wic_get_window_transform(WicPair window_dimensions);
+/** \brief combines two WicTransforms
+ *  \param a the transform to apply second
+ *  \param b the transform to apply first
+ *  \return the transform equivalent to applying b and then a
+ */
+WicTransform wic_multiply_transforms(WicTransform a, WicTransform b);
+/** \brief transforms a WicPair
+ *  \param transform the transform
+ *  \param pair the WicPair
+ *  \return the transformed WicPair
+ */
+WicPair wic_apply_transform(WicTransform transform, WicPair pair);
+/** \brief transforms an array of WicPairs
+ *
+ *  Uses SSE2 or AVX vector instructions when available.
+ *  \param transform the transform
+ *  \param pairs the WicPairs to transform
+ *  \param result the array to store the transformed WicPairs in; may be pairs
+ *  \param num_pairs the number of WicPairs
+ */
+void wic_transform_pairs(WicTransform transform, const WicPair* pairs,
+                         WicPair* result, unsigned num_pairs);
+/** \brief transforms an array of single precision points stored as 
+ *         consecutive x and y values
+ *
+ *  Uses SSE2 or AVX vector instructions when available.
+ *  \param transform the transform
+ *  \param points the points to transform
+ *  \param result the array to store the transformed points in; may be points
+ *  \param num_points the number of points (half the number of floats)
+ */
+void wic_transform_floats(WicTransform transform, const float* points,
+                          float* result, unsigned num_points);
+#endif
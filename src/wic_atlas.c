@@ -0,0 +1,281 @@
+/* ----------------------------------------------------------------------------
+ * wic - a simple 2D game engine for Mac OSX written in C
+ * Copyright (C) 2013-2017  Willis O'Leary
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * ----------------------------------------------------------------------------
+ * File:    wic_atlas.c
+ * ----------------------------------------------------------------------------
+ */
+#include "wic_atlas.h"
+struct WicTexture
+{
+    unsigned int data;
+    WicPair dimensions;
+    unsigned channels;
+    enum WicTextureStatus status;
+};
+typedef struct WicSkylineNode
+{
+    int x;     /**< the left edge of the segment */
+    int y;     /**< the height of the skyline along the segment */
+    int width; /**< the width of the segment */
+} WicSkylineNode;
+typedef struct WicAtlasPage
+{
+    WicTexture* texture;     /**< the page texture */
+    WicSkylineNode* nodes;   /**< the skyline, from left to right */
+    unsigned num_nodes;      /**< the number of skyline segments */
+} WicAtlasPage;
+struct WicAtlas
+{
+    WicPair page_dimensions; /**< the dimensions of each page */
+    unsigned channels;       /**< the number of channels in each page */
+    enum WicFilter filter;   /**< the texture filter of each page */
+    WicAtlasPage* pages;     /**< the pages */
+    unsigned num_pages;      /**< the number of pages */
+};
+unsigned char* wic_format_buffer(unsigned char* buffer, WicPair dimensions,
+                                 enum WicFormat format, unsigned channels);
+void wic_update_texture_data(unsigned data, WicPair offset,
+                             unsigned char* formatted_buffer,
+                             WicPair dimensions, unsigned channels);
+WicTexture* wic_upload_texture(unsigned char* formatted_buffer,
+                               WicPair dimensions, unsigned channels,
+                               enum WicFilter filter, enum WicWrap wrap);
+WicAtlas* wic_init_atlas(WicPair page_dimensions, enum WicFormat format,
+                         enum WicFilter filter)
+{
+    if(page_dimensions.x < 1)
+        return (void*) wic_throw_error(WIC_ERRNO_SMALL_X_DIMENSION);
+    if(page_dimensions.y < 1)
+        return (void*) wic_throw_error(WIC_ERRNO_SMALL_Y_DIMENSION);
+    
+    WicAtlas* result = malloc(sizeof(WicAtlas));
+    if(!result)
+        return (void*) wic_throw_error(WIC_ERRNO_NO_HEAP);
+    result->page_dimensions = (WicPair) {(int) page_dimensions.x,
+                                         (int) page_dimensions.y};
+    result->channels = 4;
+    if(format == WIC_MONO || format == WIC_GREYSCALE)
+        result->channels = 1;
+    result->filter = filter;
+    result->pages = 0;
+    result->num_pages = 0;
+    return result;
+}
+/* returns the lowest y a rect can sit at on node index, -1 if it can't fit */
+int wic_skyline_fit(WicAtlasPage* page, unsigned index, int width, int height,
+                    WicPair page_dimensions)
+{
+    int x = page->nodes[index].x;
+    if(x + width > page_dimensions.x)
+        return -1;
+    int y = 0;
+    int width_left = width;
+    while(width_left > 0)
+    {
+        if(page->nodes[index].y > y)
+            y = page->nodes[index].y;
+        if(y + height > page_dimensions.y)
+            return -1;
+        width_left -= page->nodes[index].width;
+        index++;
+    }
+    return y;
+}
+/* raises the skyline to cover a rect placed on node index */
+void wic_skyline_insert(WicAtlasPage* page, unsigned index, int y, int width,
+                        int height)
+{
+    WicSkylineNode node = {page->nodes[index].x, y + height, width};
+    memmove(&page->nodes[index+1], &page->nodes[index],
+            (page->num_nodes - index) * sizeof(WicSkylineNode));
+    page->nodes[index] = node;
+    page->num_nodes++;
+    for(unsigned i = index + 1; i < page->num_nodes;)
+    {
+        WicSkylineNode* previous = &page->nodes[i-1];
+        int overlap = previous->x + previous->width - page->nodes[i].x;
+        if(overlap <= 0)
+            break;
+        page->nodes[i].x += overlap;
+        page->nodes[i].width -= overlap;
+        if(page->nodes[i].width > 0)
+            break;
+        memmove(&page->nodes[i], &page->nodes[i+1],
+                (page->num_nodes - i - 1) * sizeof(WicSkylineNode));
+        page->num_nodes--;
+    }
+    for(unsigned i = 1; i < page->num_nodes;)
+    {
+        if(page->nodes[i-1].y == page->nodes[i].y)
+        {
+            page->nodes[i-1].width += page->nodes[i].width;
+            memmove(&page->nodes[i], &page->nodes[i+1],
+                    (page->num_nodes - i - 1) * sizeof(WicSkylineNode));
+            page->num_nodes--;
+        }
+        else
+            i++;
+    }
+}
+/* finds the bottom-left-most spot for a rect, returns false if none */
+bool wic_skyline_find(WicAtlasPage* page, int width, int height,
+                      WicPair page_dimensions, unsigned* index, int* y)
+{
+    int best_top = -1;
+    int best_width = 0;
+    for(unsigned i = 0; i < page->num_nodes; i++)
+    {
+        int fit = wic_skyline_fit(page, i, width, height, page_dimensions);
+        if(fit < 0)
+            continue;
+        if(best_top < 0 || fit + height < best_top ||
+           (fit + height == best_top && page->nodes[i].width < best_width))
+        {
+            best_top = fit + height;
+            best_width = page->nodes[i].width;
+            *index = i;
+            *y = fit;
+        }
+    }
+    return best_top >= 0;
+}
+bool wic_atlas_add_page(WicAtlas* target)
+{
+    int width = target->page_dimensions.x;
+    int height = target->page_dimensions.y;
+    WicAtlasPage* pages = realloc(target->pages, (target->num_pages + 1) *
+                                                 sizeof(WicAtlasPage));
+    if(!pages)
+        return wic_throw_error(WIC_ERRNO_NO_HEAP);
+    target->pages = pages;
+    WicAtlasPage* page = &pages[target->num_pages];
+    page->nodes = malloc((width + 1) * sizeof(WicSkylineNode));
+    if(!page->nodes)
+        return wic_throw_error(WIC_ERRNO_NO_HEAP);
+    unsigned char* clear_buffer = calloc(width * height * target->channels,
+                                         sizeof(unsigned char));
+    if(!clear_buffer)
+    {
+        free(page->nodes);
+        return wic_throw_error(WIC_ERRNO_NO_HEAP);
+    }
+    page->texture = wic_upload_texture(clear_buffer, target->page_dimensions,
+                                       target->channels, target->filter,
+                                       WIC_CLAMP_TO_EDGE);
+    free(clear_buffer);
+    if(!page->texture)
+    {
+        free(page->nodes);
+        return false;
+    }
+    page->nodes[0] = (WicSkylineNode) {0, 0, width};
+    page->num_nodes = 1;
+    target->num_pages++;
+    return true;
+}
+bool wic_atlas_add_buffer(WicAtlas* target, unsigned char* buffer,
+                          WicPair dimensions, enum WicFormat format,
+                          WicTexture** texture, WicBounds* bounds)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!buffer)
+        return wic_throw_error(WIC_ERRNO_NULL_BUFFER);
+    if(dimensions.x < 1)
+        return wic_throw_error(WIC_ERRNO_SMALL_X_DIMENSION);
+    if(dimensions.y < 1)
+        return wic_throw_error(WIC_ERRNO_SMALL_Y_DIMENSION);
+    if(dimensions.x > target->page_dimensions.x - 2 ||
+       dimensions.y > target->page_dimensions.y - 2)
+        return wic_throw_error(WIC_ERRNO_LARGE_DIMENSIONS);
+    if(!texture || !bounds)
+        return wic_throw_error(WIC_ERRNO_NULL_RESULT);
+    if(target->channels == 1 && format != WIC_MONO && format != WIC_GREYSCALE)
+        return wic_throw_error(WIC_ERRNO_INVALID_FORMAT);
+    
+    int width = (int) dimensions.x;
+    int height = (int) dimensions.y;
+    WicAtlasPage* page = 0;
+    unsigned index = 0;
+    int y = 0;
+    for(unsigned i = 0; i < target->num_pages && !page; i++)
+    {
+        if(wic_skyline_find(&target->pages[i], width + 2, height + 2,
+                            target->page_dimensions, &index, &y))
+            page = &target->pages[i];
+    }
+    if(!page)
+    {
+        if(!wic_atlas_add_page(target))
+            return false;
+        page = &target->pages[target->num_pages-1];
+        index = 0;
+        y = 0;
+    }
+    unsigned char* formatted_buffer = wic_format_buffer(buffer, dimensions,
+                                                        format,
+                                                        target->channels);
+    if(!formatted_buffer)
+        return false;
+    int x = page->nodes[index].x;
+    wic_update_texture_data(page->texture->data, (WicPair) {x + 1, y + 1},
+                            formatted_buffer, dimensions, target->channels);
+    free(formatted_buffer);
+    wic_skyline_insert(page, index, y, width + 2, height + 2);
+    
+    *texture = page->texture;
+    bounds->lower_left = (WicPair) {x + 1, y + 1};
+    bounds->upper_right = (WicPair) {x + 1 + width, y + 1 + height};
+    return true;
+}
+bool wic_atlas_add_file(WicAtlas* target, char* filepath, WicTexture** texture,
+                        WicBounds* bounds)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!filepath)
+        return wic_throw_error(WIC_ERRNO_NULL_FILEPATH);
+    unsigned char* buffer = 0;
+    int x = 0;
+    int y = 0;
+    buffer = SOIL_load_image(filepath, &x, &y, 0, SOIL_LOAD_RGBA);
+    if(!buffer)
+        return wic_throw_error(WIC_ERRNO_LOAD_FILE_FAIL);
+    bool result = wic_atlas_add_buffer(target, buffer, (WicPair) {x,y},
+                                       WIC_RGBA, texture, bounds);
+    SOIL_free_image_data(buffer);
+    return result;
+}
+unsigned wic_atlas_get_num_pages(WicAtlas* target)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    return target->num_pages;
+}
+bool wic_free_atlas(WicAtlas* target)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    for(unsigned i = 0; i < target->num_pages; i++)
+    {
+        wic_free_texture(target->pages[i].texture);
+        free(target->pages[i].nodes);
+    }
+    free(target->pages);
+    free(target);
+    return true;
+}
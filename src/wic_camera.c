@@ -0,0 +1,106 @@
+/* ----------------------------------------------------------------------------
+ * wic - a simple 2D game engine for Mac OSX written in C
+ * Copyright (C) 2013-2017  Willis O'Leary
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * ----------------------------------------------------------------------------
+ * File:    wic_camera.c
+ * ----------------------------------------------------------------------------
+ */
+#include "wic_camera.h"
+struct WicGame
+{
+    GLFWwindow* window;
+    WicPair dimensions;
+    WicPair pixel_density;
+    double seconds_per_frame;
+    double previous_time;
+    double delta;
+    FT_Library freetype_library;
+    enum WicPaceMode pace_mode;
+    double next_frame_time;
+    double sleep_overshoot;
+    unsigned* frame_histogram;
+    unsigned num_frames;
+    double min_frame_time;
+    double total_frame_time;
+    
+};
+bool wic_render_set_view(WicTransform view);
+bool wic_init_camera(WicCamera* target, WicPair location)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    
+    target->location = location;
+    target->zoom = 1.0;
+    target->rotation = 0.0;
+    return true;
+}
+WicTransform wic_get_camera_transform(WicCamera* target, WicGame* game)
+{
+    WicTransform result = {1, 0, 0, 1, 0, 0};
+    if(!target)
+    {
+        wic_throw_error(WIC_ERRNO_NULL_TARGET);
+        return result;
+    }
+    if(!game)
+    {
+        wic_throw_error(WIC_ERRNO_NULL_GAME);
+        return result;
+    }
+    double cosine = cos(target->rotation);
+    double sine = sin(target->rotation);
+    result.a = cosine * target->zoom;
+    result.b = -sine * target->zoom;
+    result.c = sine * target->zoom;
+    result.d = cosine * target->zoom;
+    result.tx = game->dimensions.x / 2 -
+                (result.a * target->location.x + result.c * target->location.y);
+    result.ty = game->dimensions.y / 2 -
+                (result.b * target->location.x + result.d * target->location.y);
+    return result;
+}
+WicPair wic_get_world_location(WicCamera* target, WicPair location,
+                               WicGame* game)
+{
+    if(!target)
+    {
+        wic_throw_error(WIC_ERRNO_NULL_TARGET);
+        return (WicPair) {-1,-1};
+    }
+    if(!game)
+    {
+        wic_throw_error(WIC_ERRNO_NULL_GAME);
+        return (WicPair) {-1,-1};
+    }
+    WicPair offset = wic_subtract_pairs(location,
+                                        wic_divide_pairs(game->dimensions,
+                                                         (WicPair) {2,2}));
+    double cosine = cos(target->rotation);
+    double sine = sin(target->rotation);
+    return (WicPair) {target->location.x +
+                      (cosine * offset.x - sine * offset.y) / target->zoom,
+                      target->location.y +
+                      (sine * offset.x + cosine * offset.y) / target->zoom};
+}
+bool wic_set_camera(WicCamera* target, WicGame* game)
+{
+    if(!game)
+        return wic_throw_error(WIC_ERRNO_NULL_GAME);
+    if(!target)
+        return wic_render_set_view((WicTransform) {1, 0, 0, 1, 0, 0});
+    return wic_render_set_view(wic_get_camera_transform(target, game));
+}
@@ -0,0 +1,332 @@
+/* ----------------------------------------------------------------------------
+ * wic - a simple 2D game engine for Mac OSX written in C
+ * Copyright (C) 2013-2017  Willis O'Leary
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * ----------------------------------------------------------------------------
+ * File:    wic_channel.c
+ * ----------------------------------------------------------------------------
+ */
+#include "wic_channel.h"
+static const double wic_initial_rto = 0.2;
+static const double wic_min_rto = 0.02;
+static const double wic_max_rto = 2.0;
+/* set in the channel byte of a header or ack when its ack fields are valid */
+static const uint8_t wic_acks_valid = 0x80;
+void wic_write_u16(uint8_t* buffer, uint16_t value)
+{
+    buffer[0] = value >> 8;
+    buffer[1] = value;
+}
+uint16_t wic_read_u16(uint8_t* buffer)
+{
+    return (uint16_t) (buffer[0] << 8 | buffer[1]);
+}
+void wic_write_u32(uint8_t* buffer, uint32_t value)
+{
+    wic_write_u16(buffer, value >> 16);
+    wic_write_u16(buffer + 2, value);
+}
+uint32_t wic_read_u32(uint8_t* buffer)
+{
+    return (uint32_t) wic_read_u16(buffer) << 16 | wic_read_u16(buffer + 2);
+}
+/* determines whether sequence number a is newer than b, allowing for wrap */
+bool wic_is_newer_seq(uint16_t a, uint16_t b)
+{
+    return (int16_t) (a - b) > 0;
+}
+bool wic_reset_connection(WicConnection* target)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    
+    bzero(target, sizeof(WicConnection));
+    target->rto = wic_initial_rto;
+    return true;
+}
+double wic_get_channel_time()
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+/* writes the ack and ack bitfield of a channel, which settles any owed ack */
+void wic_write_acks(WicReliableChannel* reliable, uint8_t* buffer)
+{
+    wic_write_u16(buffer, reliable->recv_seq);
+    wic_write_u32(buffer + 2, reliable->recv_bits);
+    reliable->ack_pending = false;
+}
+/* builds the header of a sequence number, piggybacking the channel's acks */
+void wic_fill_header(WicConnection* target, uint8_t channel, uint16_t seq,
+                     WicPacket* result)
+{
+    result->type = WIC_PACKET_CHANNEL;
+    result->data[0] = channel;
+    wic_write_u16(&result->data[1], seq);
+    bzero(&result->data[3], 6);
+    if(channel != WIC_CHANNEL_UNRELIABLE_SEQUENCED &&
+       target->reliable[channel].received_any)
+    {
+        result->data[0] |= wic_acks_valid;
+        wic_write_acks(&target->reliable[channel], &result->data[3]);
+    }
+}
+/* feeds a round trip time sample into the timeout as in RFC 6298 */
+void wic_sample_rtt(WicConnection* target, double rtt)
+{
+    if(!target->measured)
+    {
+        target->rtt = rtt;
+        target->rtt_var = rtt / 2;
+        target->measured = true;
+    }
+    else
+    {
+        target->rtt_var = 0.75 * target->rtt_var +
+                          0.25 * fabs(target->rtt - rtt);
+        target->rtt = 0.875 * target->rtt + 0.125 * rtt;
+    }
+    target->rto = target->rtt + 4 * target->rtt_var;
+    if(target->rto < wic_min_rto)
+        target->rto = wic_min_rto;
+    if(target->rto > wic_max_rto)
+        target->rto = wic_max_rto;
+}
+/* marks the packets covered by an ack and ack bitfield as delivered */
+void wic_apply_acks(WicConnection* target, uint8_t channel, uint16_t ack,
+                    uint32_t bits, double now)
+{
+    WicReliableChannel* reliable = &target->reliable[channel];
+    for(uint16_t seq = reliable->base; seq != reliable->next_seq; seq++)
+    {
+        unsigned slot = seq % WIC_CHANNEL_WINDOW;
+        uint16_t distance = ack - seq;
+        if(!reliable->unacked[slot] || wic_is_newer_seq(seq, ack))
+            continue;
+        if(!distance || (distance <= 32 && bits & (1u << (distance - 1))))
+        {
+            reliable->unacked[slot] = false;
+            /* resent packets are ambiguous samples, so they are skipped */
+            if(!reliable->resent[slot])
+                wic_sample_rtt(target, now - reliable->send_times[slot]);
+        }
+    }
+    while(reliable->base != reliable->next_seq &&
+          !reliable->unacked[reliable->base % WIC_CHANNEL_WINDOW])
+        reliable->base++;
+}
+/* records a received sequence number; returns whether it is new */
+bool wic_record_seq(WicReliableChannel* reliable, uint16_t seq)
+{
+    if(!reliable->received_any || wic_is_newer_seq(seq, reliable->recv_seq))
+    {
+        uint16_t shift = seq - reliable->recv_seq;
+        if(!reliable->received_any)
+            reliable->recv_bits = 0;
+        else
+        {
+            reliable->recv_bits = shift < 32 ? reliable->recv_bits << shift : 0;
+            if(shift <= 32)
+                reliable->recv_bits |= 1u << (shift - 1);
+        }
+        reliable->received_any = true;
+        reliable->recv_seq = seq;
+        return true;
+    }
+    uint16_t distance = reliable->recv_seq - seq;
+    if(!distance || distance > 32 ||
+       reliable->recv_bits & (1u << (distance - 1)))
+        return false;
+    reliable->recv_bits |= 1u << (distance - 1);
+    return true;
+}
+bool wic_connection_wrap(WicConnection* target, enum WicChannel channel,
+                         WicPacket* packet, double now, WicPacket* result)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!packet)
+        return wic_throw_error(WIC_ERRNO_NULL_PACKET);
+    if(!result)
+        return wic_throw_error(WIC_ERRNO_NULL_RESULT);
+    if((unsigned) channel > WIC_CHANNEL_UNRELIABLE_SEQUENCED)
+        return wic_throw_error(WIC_ERRNO_INVALID_CHANNEL);
+    
+    uint16_t seq;
+    if(channel == WIC_CHANNEL_UNRELIABLE_SEQUENCED)
+        seq = target->next_sequenced++;
+    else
+    {
+        WicReliableChannel* reliable = &target->reliable[channel];
+        if((uint16_t) (reliable->next_seq - reliable->base) >=
+           WIC_CHANNEL_WINDOW)
+            return wic_throw_error(WIC_ERRNO_CHANNEL_FULL);
+        seq = reliable->next_seq++;
+        unsigned slot = seq % WIC_CHANNEL_WINDOW;
+        reliable->sent[slot] = *packet;
+        reliable->send_times[slot] = now;
+        reliable->timeouts[slot] = now + target->rto;
+        reliable->unacked[slot] = true;
+        reliable->resent[slot] = false;
+    }
+    wic_fill_header(target, channel, seq, result);
+    result->sender_index = packet->sender_index;
+    return true;
+}
+bool wic_connection_unwrap(WicConnection* target, WicPacket* header,
+                           WicPacket* packet, double now)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!header || !packet)
+        return wic_throw_error(WIC_ERRNO_NULL_PACKET);
+    
+    uint8_t channel = header->data[0] & ~wic_acks_valid;
+    uint16_t seq = wic_read_u16(&header->data[1]);
+    if(channel > WIC_CHANNEL_UNRELIABLE_SEQUENCED)
+        return wic_throw_error(WIC_ERRNO_INVALID_CHANNEL);
+    if(channel == WIC_CHANNEL_UNRELIABLE_SEQUENCED)
+    {
+        if(target->received_sequenced &&
+           !wic_is_newer_seq(seq, target->recv_sequenced))
+            return false;
+        target->received_sequenced = true;
+        target->recv_sequenced = seq;
+        return true;
+    }
+    if(header->data[0] & wic_acks_valid)
+    {
+        wic_apply_acks(target, channel, wic_read_u16(&header->data[3]),
+                       wic_read_u32(&header->data[5]), now);
+    }
+    WicReliableChannel* reliable = &target->reliable[channel];
+    /* duplicates are acked again in case the first ack was lost */
+    reliable->ack_pending = true;
+    if(!wic_record_seq(reliable, seq))
+        return false;
+    if(channel == WIC_CHANNEL_RELIABLE_UNORDERED)
+        return true;
+    uint16_t ahead = seq - reliable->next_deliver;
+    if(!ahead)
+    {
+        reliable->next_deliver++;
+        return true;
+    }
+    if(ahead < WIC_CHANNEL_WINDOW)
+    {
+        unsigned slot = seq % WIC_CHANNEL_WINDOW;
+        reliable->buffer[slot] = *packet;
+        reliable->buffered[slot] = true;
+    }
+    return false;
+}
+bool wic_connection_next_ordered(WicConnection* target, WicPacket* result)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!result)
+        return wic_throw_error(WIC_ERRNO_NULL_RESULT);
+    
+    WicReliableChannel* reliable =
+        &target->reliable[WIC_CHANNEL_RELIABLE_ORDERED];
+    unsigned slot = reliable->next_deliver % WIC_CHANNEL_WINDOW;
+    if(!reliable->buffered[slot])
+        return false;
+    *result = reliable->buffer[slot];
+    reliable->buffered[slot] = false;
+    reliable->next_deliver++;
+    return true;
+}
+bool wic_connection_has_ordered(WicConnection* target)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    
+    WicReliableChannel* reliable =
+        &target->reliable[WIC_CHANNEL_RELIABLE_ORDERED];
+    return reliable->buffered[reliable->next_deliver % WIC_CHANNEL_WINDOW];
+}
+bool wic_connection_receive_ack(WicConnection* target, WicPacket* ack,
+                                double now)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!ack)
+        return wic_throw_error(WIC_ERRNO_NULL_PACKET);
+    
+    uint8_t channel = ack->data[0] & ~wic_acks_valid;
+    if(channel > WIC_CHANNEL_RELIABLE_UNORDERED)
+        return wic_throw_error(WIC_ERRNO_INVALID_CHANNEL);
+    wic_apply_acks(target, channel, wic_read_u16(&ack->data[1]),
+                   wic_read_u32(&ack->data[3]), now);
+    return true;
+}
+bool wic_connection_get_resend(WicConnection* target, double now,
+                               WicPacket* header, WicPacket** packet)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!header || !packet)
+        return wic_throw_error(WIC_ERRNO_NULL_RESULT);
+    
+    for(uint8_t channel = 0; channel < 2; channel++)
+    {
+        WicReliableChannel* reliable = &target->reliable[channel];
+        for(uint16_t seq = reliable->base; seq != reliable->next_seq; seq++)
+        {
+            unsigned slot = seq % WIC_CHANNEL_WINDOW;
+            if(!reliable->unacked[slot] || reliable->timeouts[slot] > now)
+                continue;
+            /* game traffic is lost at random rather than to congestion, so
+             * resends are not backed off, which would stall ordered delivery */
+            reliable->send_times[slot] = now;
+            reliable->timeouts[slot] = now + target->rto;
+            reliable->resent[slot] = true;
+            wic_fill_header(target, channel, seq, header);
+            header->sender_index = reliable->sent[slot].sender_index;
+            *packet = &reliable->sent[slot];
+            return true;
+        }
+    }
+    return false;
+}
+bool wic_connection_get_ack(WicConnection* target, WicPacket* result)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!result)
+        return wic_throw_error(WIC_ERRNO_NULL_RESULT);
+    
+    for(uint8_t channel = 0; channel < 2; channel++)
+    {
+        if(target->reliable[channel].ack_pending)
+        {
+            result->type = WIC_PACKET_ACK;
+            result->data[0] = channel | wic_acks_valid;
+            wic_write_acks(&target->reliable[channel], &result->data[1]);
+            return true;
+        }
+    }
+    return false;
+}
+bool wic_connection_has_unacked(WicConnection* target)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    
+    return target->reliable[0].base != target->reliable[0].next_seq ||
+           target->reliable[1].base != target->reliable[1].next_seq;
+}
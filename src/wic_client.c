@@ -23,9 +23,84 @@ static int wic_socket;
 static struct sockaddr_in wic_addr;
 static const socklen_t len_addr = sizeof(wic_addr);
 static struct sockaddr_in wic_server_addr;
-static uint8_t wic_buffer[sizeof(WicPacket)];
-static size_t wic_size_buffer = sizeof(wic_buffer);
 static bool wic_initialized = false;
+static bool wic_coalescing = false;
+static uint8_t* wic_queue;
+static size_t wic_len_queue = 0;
+static uint8_t* wic_recv_buffer;
+static size_t wic_len_recv = 0;
+static size_t wic_recv_offset = 0;
+static struct sockaddr_in wic_recv_addr;
+static WicConnection wic_connection;
+static bool wic_ordered_ready = false;
+
+/* fetches the next packet of the last received datagram, receiving a new
+ * datagram once the last one has been read; returns whether there was one */
+bool wic_client_next_packet(WicPacket* result)
+{
+    if(wic_recv_offset >= wic_len_recv)
+    {
+        socklen_t tmp_len = sizeof(wic_recv_addr);
+        ssize_t length = recvfrom(wic_socket, wic_recv_buffer,
+                                  WIC_MAX_DATAGRAM_SIZE, 0,
+                                  (struct sockaddr*) &wic_recv_addr, &tmp_len);
+        wic_len_recv = length > 0 ? length : 0;
+        wic_recv_offset = 0;
+    }
+    if(!wic_len_recv)
+        return false;
+    if(!wic_get_packet_from_datagram(wic_recv_buffer, wic_len_recv,
+                                     &wic_recv_offset, result))
+    {
+        wic_len_recv = 0;
+        return false;
+    }
+    return true;
+}
+/* determines whether the last datagram came from the server */
+bool wic_client_is_from_server()
+{
+    return wic_recv_addr.sin_addr.s_addr == wic_server_addr.sin_addr.s_addr &&
+           wic_recv_addr.sin_port == wic_server_addr.sin_port;
+}
+/* fetches the next packet to deliver, unwrapping channel packets and
+ * consuming acks along the way; returns whether there was one */
+bool wic_client_next_message(WicPacket* result)
+{
+    if(wic_ordered_ready)
+    {
+        if(wic_connection_next_ordered(&wic_connection, result))
+            return true;
+        wic_ordered_ready = false;
+    }
+    while(wic_client_next_packet(result))
+    {
+        if((result->type.id != WIC_PACKET_CHANNEL.id &&
+            result->type.id != WIC_PACKET_ACK.id) ||
+           !wic_client_is_from_server())
+            return true;
+        double now = wic_get_channel_time();
+        if(result->type.id == WIC_PACKET_ACK.id)
+        {
+            wic_connection_receive_ack(&wic_connection, result, now);
+            continue;
+        }
+        /* the channel's packet follows its header in the same datagram */
+        WicPacket header = *result;
+        if(!wic_get_packet_from_datagram(wic_recv_buffer, wic_len_recv,
+                                         &wic_recv_offset, result))
+        {
+            wic_len_recv = 0;
+            continue;
+        }
+        if(wic_connection_unwrap(&wic_connection, &header, result, now))
+        {
+            wic_ordered_ready = true;
+            return true;
+        }
+    }
+    return false;
+}
 
 bool wic_init_client(WicClient* target, char* name, unsigned server_port,
                      char* server_ip)
@@ -47,9 +122,16 @@ bool wic_init_client(WicClient* target, char* name, unsigned server_port,
     if(strlen(server_ip) < 7)
         return wic_throw_error(WIC_ERRNO_SMALL_LEN_SERVER_IP);
     
+    /* the send queue followed by the receive buffer */
+    wic_queue = malloc(2 * WIC_MAX_DATAGRAM_SIZE);
+    if(!wic_queue)
+        return wic_throw_error(WIC_ERRNO_NO_HEAP);
     wic_socket = socket(AF_INET, SOCK_DGRAM, 0);
     if(wic_socket == -1)
+    {
+        free(wic_queue);
         return wic_throw_error(WIC_ERRNO_SOCKET_FAIL);
+    }
     fcntl(wic_socket, F_SETFL, O_NONBLOCK);
     bzero(&wic_addr, sizeof(wic_addr));
     wic_addr.sin_family = AF_INET;
@@ -59,6 +141,7 @@ bool wic_init_client(WicClient* target, char* name, unsigned server_port,
     if(result == -1)
     {
         close(wic_socket);
+        free(wic_queue);
         if(errno == EADDRINUSE)
             return wic_throw_error(WIC_ERRNO_PORT_IN_USE);
         else
@@ -68,6 +151,11 @@ bool wic_init_client(WicClient* target, char* name, unsigned server_port,
     wic_server_addr.sin_family = AF_INET;
     wic_server_addr.sin_addr.s_addr = inet_addr(server_ip);
     wic_server_addr.sin_port = htons((server_port));
+    wic_recv_buffer = wic_queue + WIC_MAX_DATAGRAM_SIZE;
+    wic_len_queue = 0;
+    wic_len_recv = 0;
+    wic_recv_offset = 0;
+    wic_coalescing = false;
     
     target->joined = false;
     target->name = name;
@@ -91,16 +179,13 @@ bool wic_client_join_server(WicClient* target, WicPacket* result,
     packet.type = WIC_PACKET_REQUEST_JOIN;
     memcpy(packet.data, target->name, strlen(target->name) + 1);
     wic_client_send_packet(target, &packet);
+    wic_client_flush(target);
     clock_t initial_clock = clock();
     while((clock() - initial_clock)/CLOCKS_PER_SEC <= timeout)
     {
-        struct sockaddr_in recv_addr;
-        socklen_t tmp_len = sizeof(recv_addr);
-        ssize_t length = recvfrom(wic_socket, wic_buffer, wic_size_buffer, 0,
-                                  (struct sockaddr*) &recv_addr, &tmp_len);
-        if(length > 0)
+        /* the rest of the response datagram is left for recv_packet */
+        if(wic_client_next_packet(result))
         {
-            wic_get_packet_from_buffer(wic_buffer, result);
             if(result->type.id == WIC_PACKET_RESPOND_JOIN.id)
             {
                 if(result->data[0] == WIC_PACKET_RESPOND_JOIN_OKAY)
@@ -127,7 +212,9 @@ bool wic_client_join_server(WicClient* target, WicPacket* result,
                             return wic_throw_error(WIC_ERRNO_NO_HEAP);
                         }
                     }
-                    wic_server_addr = recv_addr;
+                    wic_server_addr = wic_recv_addr;
+                    wic_reset_connection(&wic_connection);
+                    wic_ordered_ready = false;
                     target->joined = true;
                     target->index = result->data[2];
                     target->used = used;
@@ -147,6 +234,60 @@ bool wic_client_join_server(WicClient* target, WicPacket* result,
     }
     return wic_throw_error(WIC_ERRNO_TIMEOUT);
 }
+bool wic_client_set_coalescing(WicClient* target, bool coalescing)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    
+    if(!coalescing)
+        wic_client_flush(target);
+    wic_coalescing = coalescing;
+    return true;
+}
+bool wic_client_flush(WicClient* target)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    
+    if(wic_len_queue)
+    {
+        WIC_PROFILE_BEGIN("wic_client_flush");
+        sendto(wic_socket, wic_queue, wic_len_queue, 0,
+               (struct sockaddr*) &wic_server_addr, len_addr);
+        wic_len_queue = 0;
+        WIC_PROFILE_END("wic_client_flush");
+    }
+    return true;
+}
+/* sends one or two packets to the server in a single datagram, or queues
+ * them together while coalescing */
+void wic_client_send_records(WicClient* target, WicPacket* first,
+                             WicPacket* second)
+{
+    size_t len_first = WIC_PACKET_HEADER_SIZE + first->type.size;
+    size_t size = len_first;
+    if(second)
+        size += WIC_PACKET_HEADER_SIZE + second->type.size;
+    if(wic_coalescing)
+    {
+        if(wic_len_queue + size > WIC_MAX_DATAGRAM_SIZE)
+            wic_client_flush(target);
+        wic_convert_packet_to_buffer(wic_queue + wic_len_queue, first);
+        if(second)
+        {
+            wic_convert_packet_to_buffer(wic_queue + wic_len_queue + len_first,
+                                         second);
+        }
+        wic_len_queue += size;
+        return;
+    }
+    uint8_t datagram[2 * sizeof(WicPacket)];
+    wic_convert_packet_to_buffer(datagram, first);
+    if(second)
+        wic_convert_packet_to_buffer(datagram + len_first, second);
+    sendto(wic_socket, datagram, size, 0, (struct sockaddr*) &wic_server_addr,
+           len_addr);
+}
 bool wic_client_send_packet(WicClient* target, WicPacket* packet)
 {
     if(!target)
@@ -154,13 +295,68 @@ bool wic_client_send_packet(WicClient* target, WicPacket* packet)
     if(!packet)
         return wic_throw_error(WIC_ERRNO_NULL_PACKET);
     
+    WIC_PROFILE_BEGIN("wic_client_send_packet");
     packet->sender_index = target->index;
-    size_t size = WIC_PACKET_HEADER_SIZE + packet->type.size;
-    wic_convert_packet_to_buffer(wic_buffer, packet);
-    sendto(wic_socket, wic_buffer, size, 0, (struct sockaddr*) &wic_server_addr,
-           len_addr);
+    wic_client_send_records(target, packet, 0);
+    WIC_PROFILE_END("wic_client_send_packet");
     return true;
 }
+bool wic_client_send_channel_packet(WicClient* target, WicPacket* packet,
+                                    enum WicChannel channel)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!packet)
+        return wic_throw_error(WIC_ERRNO_NULL_PACKET);
+    if(!target->joined)
+        return wic_throw_error(WIC_ERRNO_CLIENT_NOT_JOINED);
+    
+    WIC_PROFILE_BEGIN("wic_client_send_channel_packet");
+    packet->sender_index = target->index;
+    WicPacket header;
+    bool result = wic_connection_wrap(&wic_connection, channel, packet,
+                                      wic_get_channel_time(), &header);
+    if(result)
+        wic_client_send_records(target, &header, packet);
+    WIC_PROFILE_END("wic_client_send_channel_packet");
+    return result;
+}
+/* sends every ack owed to the server */
+void wic_client_send_acks(WicClient* target)
+{
+    WicPacket ack;
+    while(wic_connection_get_ack(&wic_connection, &ack))
+    {
+        ack.sender_index = target->index;
+        wic_client_send_records(target, &ack, 0);
+    }
+}
+bool wic_client_update_channels(WicClient* target)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!target->joined)
+        return wic_throw_error(WIC_ERRNO_CLIENT_NOT_JOINED);
+    
+    WIC_PROFILE_BEGIN("wic_client_update_channels");
+    WicPacket header;
+    WicPacket* packet;
+    while(wic_connection_get_resend(&wic_connection, wic_get_channel_time(),
+                                    &header, &packet))
+        wic_client_send_records(target, &header, packet);
+    wic_client_send_acks(target);
+    WIC_PROFILE_END("wic_client_update_channels");
+    return true;
+}
+WicConnection* wic_client_get_connection(WicClient* target)
+{
+    if(!target)
+        return (void*) wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!target->joined)
+        return (void*) wic_throw_error(WIC_ERRNO_CLIENT_NOT_JOINED);
+    
+    return &wic_connection;
+}
 bool wic_client_recv_packet(WicClient* target, WicPacket* result)
 {
     if(!target)
@@ -170,16 +366,13 @@ bool wic_client_recv_packet(WicClient* target, WicPacket* result)
     if(!target->joined)
         return wic_throw_error(WIC_ERRNO_CLIENT_NOT_JOINED);
     
-    struct sockaddr_in recv_addr;
-    socklen_t tmp_len = sizeof(recv_addr);
-    ssize_t length = recvfrom(wic_socket, wic_buffer, wic_size_buffer, 0,
-                              (struct sockaddr*) &recv_addr, &tmp_len);
-    if(length > 0)
+    WIC_PROFILE_BEGIN("wic_client_recv_packet");
+    bool received = wic_client_next_message(result);
+    WIC_PROFILE_END("wic_client_recv_packet");
+    if(received)
     {
-        if(recv_addr.sin_addr.s_addr == wic_server_addr.sin_addr.s_addr &&
-           recv_addr.sin_port == wic_server_addr.sin_port)
+        if(wic_client_is_from_server())
         {
-            wic_get_packet_from_buffer(wic_buffer, result);
             WicNodeIndex index;
             if(result->type.id == WIC_PACKET_CLIENT_JOINED.id ||
                result->type.id == WIC_PACKET_IN_CLIENT.id)
@@ -192,6 +385,9 @@ bool wic_client_recv_packet(WicClient* target, WicPacket* result)
                     result->type.id == WIC_PACKET_BAN_CLIENT.id ||
                     result->type.id == WIC_PACKET_SERVER_SHUTDOWN.id)
             {
+                /* the server waits for the kick or ban to be acknowledged */
+                wic_client_send_acks(target);
+                wic_client_flush(target);
                 target->joined = false;
             }
             else if(result->type.id == WIC_PACKET_CLIENT_LEFT.id)
@@ -205,6 +401,28 @@ bool wic_client_recv_packet(WicClient* target, WicPacket* result)
     }
     return false;
 }
+bool wic_client_wait(WicClient* target, double timeout)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    
+    if(wic_recv_offset < wic_len_recv ||
+       (wic_ordered_ready && wic_connection_has_ordered(&wic_connection)))
+        return true;
+    WIC_PROFILE_BEGIN("wic_client_wait");
+    bool ready = wic_wait_socket(wic_socket, timeout);
+    WIC_PROFILE_END("wic_client_wait");
+    return ready;
+}
+int wic_client_get_socket(WicClient* target)
+{
+    if(!target)
+    {
+        wic_throw_error(WIC_ERRNO_NULL_TARGET);
+        return -1;
+    }
+    return wic_socket;
+}
 bool wic_client_leave(WicClient* target)
 {
     if(!target)
@@ -215,6 +433,7 @@ bool wic_client_leave(WicClient* target)
     WicPacket packet;
     packet.type = WIC_PACKET_LEAVE;
     wic_client_send_packet(target, &packet);
+    wic_client_flush(target);
     target->joined = false;
     return true;
 }
@@ -225,6 +444,12 @@ bool wic_free_client(WicClient* target)
     
     close(wic_socket);
     wic_socket = -1;
+    free(wic_queue);
+    wic_queue = 0;
+    wic_recv_buffer = 0;
+    wic_len_queue = 0;
+    wic_len_recv = 0;
+    wic_coalescing = false;
     bzero(&wic_addr, len_addr);
     bzero(&wic_server_addr, len_addr);
     target->max_nodes = 0;
@@ -138,6 +138,55 @@ void wic_print_errno_string()
             strcat(message, "name_or_ip was never banned"); break;
         case WIC_ERRNO_NO_SUCH_CLIENT:
             strcat(message, "no client found for name_or_ip"); break;
+        case WIC_ERRNO_SMALL_CAPACITY:
+            strcat(message, "capacity is 0"); break;
+        case WIC_ERRNO_LARGE_DIMENSIONS:
+            strcat(message, "dimensions do not fit in an atlas page"); break;
+        case WIC_ERRNO_THREAD_FAIL:
+            strcat(message, "thread creation failed"); break;
+        case WIC_ERRNO_SMALL_BUDGET:
+            strcat(message, "budget is less than 0"); break;
+        case WIC_ERRNO_INVALID_FORMAT:
+            strcat(message, "format does not fit a single channel atlas");
+            break;
+        case WIC_ERRNO_NULL_CALLBACK:
+            strcat(message, "callback is null"); break;
+        case WIC_ERRNO_SMALL_TICK_RATE:
+            strcat(message, "tick rate is less than 1"); break;
+        case WIC_ERRNO_SMALL_MAX_TICKS:
+            strcat(message, "max ticks is less than 1"); break;
+        case WIC_ERRNO_WRITE_FILE_FAIL:
+            strcat(message, "file could not be written"); break;
+        case WIC_ERRNO_ALREADY_RECORDING:
+            strcat(message, "input is already being recorded or replayed");
+            break;
+        case WIC_ERRNO_NOT_RECORDING:
+            strcat(message, "input is not being recorded"); break;
+        case WIC_ERRNO_NOT_REPLAYING:
+            strcat(message, "input is not being replayed"); break;
+        case WIC_ERRNO_INVALID_LOG:
+            strcat(message, "file is not a valid input log"); break;
+        case WIC_ERRNO_SHADER_FAIL:
+            strcat(message, "failed to compile or link a shader"); break;
+        case WIC_ERRNO_MALFORMED_DATAGRAM:
+            strcat(message, "received a malformed datagram"); break;
+        case WIC_ERRNO_INVALID_CHANNEL:
+            strcat(message, "channel is not a valid WicChannel"); break;
+        case WIC_ERRNO_CHANNEL_FULL:
+            strcat(message, "too many unacknowledged packets on channel");
+            break;
+        case WIC_ERRNO_SMALL_ENTITY_SIZE:
+            strcat(message, "entity_size must be > 0"); break;
+        case WIC_ERRNO_LARGE_ENTITY_SIZE:
+            strcat(message, "entity_size must be <= 246"); break;
+        case WIC_ERRNO_SMALL_NUM_ENTITIES:
+            strcat(message, "num_entities must be > 0"); break;
+        case WIC_ERRNO_LARGE_SNAPSHOT:
+            strcat(message, "snapshot does not fit in 255 packets"); break;
+        case WIC_ERRNO_NULL_SERVER:
+            strcat(message, "server is null"); break;
+        case WIC_ERRNO_NULL_CLIENT:
+            strcat(message, "client is null"); break;
 	}
 	strcat(message, "\n");
 	fprintf(stderr, "%s", message);
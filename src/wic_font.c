@@ -29,20 +29,165 @@ struct WicGame
     double previous_time;
     double delta;
     FT_Library freetype_library;
+    enum WicPaceMode pace_mode;
+    double next_frame_time;
+    double sleep_overshoot;
+    unsigned* frame_histogram;
+    unsigned num_frames;
+    double min_frame_time;
+    double total_frame_time;
     
 };
-struct WicTexture
-{
-    unsigned int data;
-    WicPair dimensions;
-};
 struct WicFont
 {
     FT_Face face;           /**< the face */
-    WicTexture** textures;   /**< the glyph textures */
+    WicAtlas* atlas;        /**< the glyph atlas */
+    WicTexture* texture;    /**< the glyph atlas texture */
+    WicBounds* glyphs;      /**< the bounds of each glyph within texture; 
+                             *   empty for glyphs with no bitmap */
     unsigned short point;   /**< the point size measured in font points */
     bool antialias;         /**< whether or not to antialias the font */
 };
+typedef struct WicGlyphJob
+{
+    const unsigned char* font;  /**< the font file, loaded into memory */
+    size_t len_font;            /**< the length of the font file */
+    unsigned point;             /**< the point size */
+    WicPair pixel_density;      /**< the pixel density of the game */
+    bool antialias;             /**< whether or not to antialias glyphs */
+    unsigned char** bitmaps;    /**< the rendered glyph bitmaps */
+    WicPair* dimensions;        /**< the dimensions of each bitmap */
+    bool* rendered;             /**< whether or not each glyph was rendered */
+    bool failed;                /**< whether or not a bitmap copy could not
+                                 *   be allocated */
+} WicGlyphJob;
+/* renders a glyph into a copy of its bitmap that must be freed, or 0 if the
+ * glyph has no bitmap; returns false if the copy could not be allocated */
+bool wic_render_glyph(FT_Face face, unsigned char c, bool antialias,
+                      FT_Library library, unsigned char** result,
+                      WicPair* dimensions)
+{
+    *result = 0;
+    int glyph_index = FT_Get_Char_Index(face, c);
+    if(antialias)
+        FT_Load_Glyph(face, glyph_index, FT_LOAD_FORCE_AUTOHINT);
+    else
+        FT_Load_Glyph(face, glyph_index, 0);
+    FT_Bitmap bitmap;
+    FT_Bitmap_New(&bitmap);
+    if(antialias)
+    {
+        if(FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL) ||
+           face->glyph->bitmap.buffer == 0)
+            return true;
+        bitmap = face->glyph->bitmap;
+    }
+    else
+    {
+        if(FT_Render_Glyph(face->glyph, FT_RENDER_MODE_MONO) ||
+           face->glyph->bitmap.buffer == 0)
+            return true;
+        FT_Bitmap_Convert(library, &face->glyph->bitmap, &bitmap, 1);
+    }
+    *dimensions = (WicPair) {bitmap.width, bitmap.rows};
+    size_t size = bitmap.width * bitmap.rows;
+    *result = malloc(size);
+    if(*result)
+        memcpy(*result, bitmap.buffer, size);
+    if(!antialias)
+        FT_Bitmap_Done(library, &bitmap);
+    return *result != 0;
+}
+/* renders glyphs [start, end) with a private library and face over the shared
+ * font file, since FreeType objects must not be shared between threads */
+void wic_render_glyphs(unsigned start, unsigned end, void* argument)
+{
+    WicGlyphJob* job = argument;
+    FT_Library library;
+    if(FT_Init_FreeType(&library))
+        return;
+    FT_Face face;
+    if(FT_New_Memory_Face(library, job->font, job->len_font, 0, &face))
+    {
+        FT_Done_FreeType(library);
+        return;
+    }
+    FT_Set_Char_Size(face, 0, job->point*64, job->pixel_density.x,
+                     job->pixel_density.y);
+    for(unsigned c = start; c < end; c++)
+    {
+        if(wic_render_glyph(face, c, job->antialias, library,
+                            &job->bitmaps[c], &job->dimensions[c]))
+            job->rendered[c] = true;
+        else
+            __atomic_store_n(&job->failed, true, __ATOMIC_RELAXED);
+    }
+    FT_Done_Face(face);
+    FT_Done_FreeType(library);
+}
+/* loads a whole file into a buffer that must be freed, or returns 0 */
+unsigned char* wic_load_font_file(const char* filepath, size_t* length)
+{
+    FILE* file = fopen(filepath, "rb");
+    if(!file)
+        return 0;
+    unsigned char* result = 0;
+    long size = -1;
+    if(!fseek(file, 0, SEEK_END))
+        size = ftell(file);
+    if(size > 0 && !fseek(file, 0, SEEK_SET))
+        result = malloc(size);
+    if(result && fread(result, 1, size, file) != (size_t) size)
+    {
+        free(result);
+        result = 0;
+    }
+    fclose(file);
+    if(result)
+        *length = size;
+    return result;
+}
+/* packs every glyph bitmap into an atlas with a single page */
+WicAtlas* wic_pack_glyphs(unsigned char** bitmaps, WicPair* dimensions,
+                          enum WicFormat format, WicBounds* glyphs,
+                          WicTexture** texture)
+{
+    double area = 0;
+    WicPair max_dimensions = {0,0};
+    for(unsigned char c = 0; c < WIC_FONT_NUM_CHARS; c++)
+    {
+        if(!bitmaps[c])
+            continue;
+        area += (dimensions[c].x + 2) * (dimensions[c].y + 2);
+        max_dimensions.x = fmax(max_dimensions.x, dimensions[c].x + 2);
+        max_dimensions.y = fmax(max_dimensions.y, dimensions[c].y + 2);
+    }
+    double side = ceil(sqrt(area * 1.25));
+    WicPair page_dimensions = {fmax(side, max_dimensions.x),
+                               fmax(side, max_dimensions.y)};
+    while(true)
+    {
+        WicAtlas* result = wic_init_atlas(page_dimensions, format,
+                                          WIC_NEAREST);
+        if(!result)
+            return 0;
+        *texture = 0;
+        for(unsigned char c = 0; c < WIC_FONT_NUM_CHARS; c++)
+        {
+            if(bitmaps[c] && !wic_atlas_add_buffer(result, bitmaps[c],
+                                                   dimensions[c], format,
+                                                   texture, &glyphs[c]))
+            {
+                wic_free_atlas(result);
+                return 0;
+            }
+        }
+        if(wic_atlas_get_num_pages(result) <= 1)
+            return result;
+        wic_free_atlas(result);
+        page_dimensions.y = ceil(page_dimensions.y * 1.25);
+    }
+}
 WicFont* wic_init_font(const char* filepath, unsigned point, bool antialias,
                        WicGame* game)
 {
@@ -56,101 +201,106 @@ WicFont* wic_init_font(const char* filepath, unsigned point, bool antialias,
     int error = FT_New_Face(game->freetype_library, filepath, 0, &face);
     if(error != 0)
         return (void*) wic_throw_error(WIC_ERRNO_LOAD_FILE_FAIL);
-    WicTexture** textures = malloc(WIC_FONT_NUM_CHARS * sizeof(WicTexture*));
-    bzero(textures, WIC_FONT_NUM_CHARS * sizeof(WicTexture*));
-    if(!textures)
+    WicBounds* glyphs = calloc(WIC_FONT_NUM_CHARS, sizeof(WicBounds));
+    unsigned char** bitmaps = calloc(WIC_FONT_NUM_CHARS,
+                                     sizeof(unsigned char*));
+    WicPair* dimensions = calloc(WIC_FONT_NUM_CHARS, sizeof(WicPair));
+    if(!glyphs || !bitmaps || !dimensions)
     {
+        free(glyphs);
+        free(bitmaps);
+        free(dimensions);
         FT_Done_Face(face);
         return (void*) wic_throw_error(WIC_ERRNO_NO_HEAP);
     }
     FT_Set_Char_Size(face, 0, point*64, game->pixel_density.x,
                      game->pixel_density.y);
+    bool rendered[WIC_FONT_NUM_CHARS];
+    memset(rendered, 0, sizeof(rendered));
+    WicGlyphJob job = {0, 0, point, game->pixel_density, antialias, bitmaps,
+                       dimensions, rendered, false};
+    unsigned num_workers = wic_get_num_workers();
+    if(num_workers)
+        job.font = wic_load_font_file(filepath, &job.len_font);
+    if(job.font)
+        wic_parallel_for(WIC_FONT_NUM_CHARS,
+                         WIC_FONT_NUM_CHARS / (num_workers + 1) + 1,
+                         wic_render_glyphs, &job);
+    free((void*) job.font);
+    /* glyphs whose chunk could not open the font are rendered here instead */
+    for(unsigned char c = 0; c < WIC_FONT_NUM_CHARS && !job.failed; c++)
+    {
+        if(!rendered[c] && !wic_render_glyph(face, c, antialias,
+                                             game->freetype_library,
+                                             &bitmaps[c], &dimensions[c]))
+            job.failed = true;
+    }
+    if(job.failed)
+    {
+        for(unsigned char c = 0; c < WIC_FONT_NUM_CHARS; c++)
+            free(bitmaps[c]);
+        free(bitmaps);
+        free(dimensions);
+        free(glyphs);
+        FT_Done_Face(face);
+        return (void*) wic_throw_error(WIC_ERRNO_NO_HEAP);
+    }
+    WicTexture* texture = 0;
+    WicAtlas* atlas = wic_pack_glyphs(bitmaps, dimensions,
+                                      antialias ? WIC_GREYSCALE : WIC_MONO,
+                                      glyphs, &texture);
     for(unsigned char c = 0; c < WIC_FONT_NUM_CHARS; c++)
+        free(bitmaps[c]);
+    free(bitmaps);
+    free(dimensions);
+    if(!atlas)
     {
-        int glyph_index = FT_Get_Char_Index(face, c);
-        if(antialias)
-            FT_Load_Glyph(face, glyph_index, FT_LOAD_FORCE_AUTOHINT);
-        else
-            FT_Load_Glyph(face, glyph_index, 0);
-        if(antialias)
-        {
-            if(!FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL) &&
-               face->glyph->bitmap.buffer != 0)
-            {
-                WicPair dimensions = {face->glyph->bitmap.width,
-                                      face->glyph->bitmap.rows};
-                textures[c] =
-                wic_init_texture_from_buffer(face->glyph->bitmap.buffer,
-                                             dimensions, WIC_GREYSCALE,
-                                             WIC_NEAREST, WIC_STOP);
-                if(!textures[c])
-                {
-                    c--;
-                    for(; c >= 0; c--)
-                        wic_free_texture(textures[c]);
-                    free(textures);
-                    FT_Done_Face(face);
-                    return (void*) wic_throw_error(wic_errno);
-                }
-            }
-        }
-        else
-        {
-            if(!FT_Render_Glyph(face->glyph, FT_RENDER_MODE_MONO) &&
-               face->glyph->bitmap.buffer != 0)
-            {
-                FT_Bitmap target;
-                FT_Bitmap_New(&target);
-                int error = FT_Bitmap_Convert(game->freetype_library,
-                                              &face->glyph->bitmap,
-                                              &target, 1);
-                WicPair dimensions = {target.width, target.rows};
-                textures[c] = wic_init_texture_from_buffer(target.buffer,
-                                                           dimensions, WIC_MONO,
-                                                           WIC_NEAREST,
-                                                           WIC_STOP);
-                FT_Bitmap_Done(game->freetype_library, &target);
-                if(!textures[c])
-                {
-                    c--;
-                    for(; c >= 0; c--)
-                        wic_free_texture(textures[c]);
-                    FT_Done_Face(face);
-                    return (void*) wic_throw_error(wic_errno);
-                }
-            }
-        }
+        free(glyphs);
+        FT_Done_Face(face);
+        return (void*) wic_throw_error(wic_errno);
     }
     
     WicFont* result = malloc(sizeof(WicFont));
     if(!result)
     {
-        for(char c = 0; c < WIC_FONT_NUM_CHARS; c++)
-            wic_free_texture(textures[c]);
-        free(textures);
+        wic_free_atlas(atlas);
+        free(glyphs);
         FT_Done_Face(face);
-        wic_throw_error(WIC_ERRNO_NO_HEAP);
+        return (void*) wic_throw_error(WIC_ERRNO_NO_HEAP);
     }
     result->face = face;
-    result->textures = textures;
+    result->atlas = atlas;
+    result->texture = texture;
+    result->glyphs = glyphs;
     result->point = point;
     result->antialias = antialias;
     return result;
 }
+size_t wic_font_get_memory(WicFont* target)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!target->texture)
+        return 0;
+    return wic_texture_get_memory(target->texture);
+}
+size_t wic_font_get_saved_memory(WicFont* target)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    return wic_font_get_memory(target) * 3;
+}
 bool wic_free_font(WicFont* target)
 {
     if(!target)
         return wic_throw_error(WIC_ERRNO_NULL_TARGET);
     FT_Done_Face(target->face);
     target->face = 0;
-    for(unsigned char c = 0; c < WIC_FONT_NUM_CHARS; c++)
-    {
-        if(target->textures[c] != 0)
-            wic_free_texture(target->textures[c]);
-        target->textures[c] = 0;
-    }
-    free(target->textures);
-    target->textures = 0;
+    wic_free_atlas(target->atlas);
+    target->atlas = 0;
+    target->texture = 0;
+    free(target->glyphs);
+    target->glyphs = 0;
     target->point = 0;
     target->antialias = false;
     return true;
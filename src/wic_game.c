@@ -21,17 +21,133 @@
 #include "wic_game.h"
 const unsigned WIC_GAME_CONTINUE = 1;
 const unsigned WIC_GAME_TERMINATE = 2;
+static const double WIC_SPIN_MARGIN = 0.002;
+static const double WIC_BUCKET_WIDTH = 0.0001;
+static const unsigned WIC_NUM_BUCKETS = 1000;
+static bool wic_initialized = false;
+struct WicGame
+{
+    GLFWwindow* window;
+    WicPair dimensions;
+    WicPair pixel_density;
+    double seconds_per_frame;
+    double previous_time;
+    double delta;
+    FT_Library freetype_library;
+    enum WicPaceMode pace_mode;
+    double next_frame_time;
+    double sleep_overshoot;
+    unsigned* frame_histogram;
+    unsigned num_frames;
+    double min_frame_time;
+    double total_frame_time;
+
+};
+bool wic_start_render_thread(GLFWwindow* window);
+void wic_stop_render_thread();
+bool wic_render_is_threaded();
+void wic_render_call(void (*function)(void*), void* data);
+void wic_render_submit();
+void wic_render_begin_frame();
+void wic_render_end_frame();
+unsigned wic_render_get_num_culled();
+bool wic_init_renderer(enum WicBackend backend, WicPair dimensions);
+void wic_free_renderer();
+#define WIC_NUM_KEYS 360
+#define WIC_EVENT_CAPACITY 1024
 static bool wic_focus = false;
-static bool wic_down_keys[360] = {0};
-static bool wic_pressed_keys[360] = {0};
+static uint32_t wic_down_keys[(WIC_NUM_KEYS + 31) / 32] = {0};
+static uint32_t wic_pressed_keys[(WIC_NUM_KEYS + 31) / 32] = {0};
 static unsigned char wic_input[100] = {0};
+static unsigned wic_len_input = 0;
 static WicPair wic_cursor_location = {0.0,0.0};
 static WicPair wic_scroll_offset = {0.0,0.0};
+static WicEvent wic_events[WIC_EVENT_CAPACITY];
+static unsigned wic_event_head = 0;
+static unsigned wic_event_tail = 0;
+static const char WIC_LOG_MAGIC[4] = {'W','I','C','I'};
+static const uint32_t WIC_LOG_VERSION = 1;
+static const uint8_t WIC_LOG_FRAME = 255;
+static FILE* wic_record_file = 0;
+static FILE* wic_replay_file = 0;
+static bool wic_replay_paced = true;
+static double wic_replay_time = 0.0;
+/* set while wic_run_game clears input per tick rather than per frame */
+static bool wic_input_latched = false;
 void wic_reset_input()
 {
-    memset(wic_pressed_keys, 0, sizeof(wic_down_keys));
-    memset(wic_input, 0, sizeof(wic_input));
+    memset(wic_pressed_keys, 0, sizeof(wic_pressed_keys));
+    memset(wic_input, 0, wic_len_input);
+    wic_len_input = 0;
     wic_scroll_offset = (WicPair) {0,0};
+    __atomic_store_n(&wic_event_tail,
+                     __atomic_load_n(&wic_event_head, __ATOMIC_ACQUIRE),
+                     __ATOMIC_RELEASE);
+}
+/* writes an event to an input log */
+void wic_write_event(FILE* file, WicEvent* event)
+{
+    uint8_t type = event->type;
+    fwrite(&type, sizeof(type), 1, file);
+    fwrite(&event->time, sizeof(event->time), 1, file);
+    if(event->type == WIC_EVENT_CHAR)
+        fwrite(&event->character, sizeof(event->character), 1, file);
+    else if(event->type == WIC_EVENT_CURSOR || event->type == WIC_EVENT_SCROLL)
+        fwrite(&event->pair, sizeof(event->pair), 1, file);
+    else
+    {
+        uint16_t key = event->key;
+        fwrite(&key, sizeof(key), 1, file);
+    }
+}
+/* reads an event of the given type from an input log */
+bool wic_read_event(FILE* file, uint8_t type, WicEvent* result)
+{
+    if(type > WIC_EVENT_SCROLL)
+        return false;
+    *result = (WicEvent) {type, 0.0, 0, 0, {0,0}};
+    if(fread(&result->time, sizeof(result->time), 1, file) != 1)
+        return false;
+    if(type == WIC_EVENT_CHAR)
+        return fread(&result->character, sizeof(result->character), 1,
+                     file) == 1;
+    if(type == WIC_EVENT_CURSOR || type == WIC_EVENT_SCROLL)
+        return fread(&result->pair, sizeof(result->pair), 1, file) == 1;
+    uint16_t key;
+    if(fread(&key, sizeof(key), 1, file) != 1 || key >= WIC_NUM_KEYS)
+        return false;
+    result->key = key;
+    return true;
+}
+/* updates the input state with an event and adds it to the event queue */
+void wic_apply_event(WicEvent* event)
+{
+    if(wic_record_file)
+        wic_write_event(wic_record_file, event);
+    unsigned key = event->key;
+    if(event->type == WIC_EVENT_KEY_PRESS)
+    {
+        wic_down_keys[key / 32] |= 1u << key % 32;
+        wic_pressed_keys[key / 32] |= 1u << key % 32;
+    }
+    else if(event->type == WIC_EVENT_KEY_RELEASE)
+        wic_down_keys[key / 32] &= ~(1u << key % 32);
+    else if(event->type == WIC_EVENT_CHAR)
+    {
+        if(event->character < 256 && wic_len_input < 99)
+            wic_input[wic_len_input++] = (unsigned char) event->character;
+    }
+    else if(event->type == WIC_EVENT_CURSOR)
+        wic_cursor_location = event->pair;
+    else if(event->type == WIC_EVENT_SCROLL)
+        wic_scroll_offset = wic_add_pairs(wic_scroll_offset, event->pair);
+    
+    unsigned head = wic_event_head;
+    if(head - __atomic_load_n(&wic_event_tail, __ATOMIC_ACQUIRE) ==
+       WIC_EVENT_CAPACITY)
+        return;
+    wic_events[head % WIC_EVENT_CAPACITY] = *event;
+    __atomic_store_n(&wic_event_head, head + 1, __ATOMIC_RELEASE);
 }
 void wic_error_callback(int error, const char* description)
 {
@@ -44,69 +160,58 @@ void wic_focus_callback(GLFWwindow* window, int n)
 void wic_key_callback(GLFWwindow* window, int key, int scancode, int action,
                       int mods)
 {
-    if(wic_focus && key < 360)
+    if(wic_focus && !wic_replay_file && key >= 0 && key < WIC_NUM_KEYS)
     {
+        WicEvent event = {WIC_EVENT_KEY_PRESS, glfwGetTime(), key, 0, {0,0}};
         if(action == GLFW_RELEASE)
-            wic_down_keys[key] = false;
-        else if(action == GLFW_PRESS)
-        {
-            wic_down_keys[key] = true;
-            wic_pressed_keys[key] = true;
-        }
+            event.type = WIC_EVENT_KEY_RELEASE;
+        else if(action == GLFW_REPEAT)
+            event.type = WIC_EVENT_KEY_REPEAT;
+        wic_apply_event(&event);
     }
 }
 void wic_char_callback(GLFWwindow* window, unsigned int key)
 {
-    if(wic_focus)
+    if(wic_focus && !wic_replay_file)
     {
-        int startIndex = 0;
-        while(startIndex < 100 && wic_input[startIndex] != 0)
-            startIndex++;
-        if(startIndex != 99)
-            wic_input[startIndex] = (unsigned char) key;
+        WicEvent event = {WIC_EVENT_CHAR, glfwGetTime(), 0, key, {0,0}};
+        wic_apply_event(&event);
     }
 }
 void wic_cursor_location_callback(GLFWwindow* window, double x, double y)
 {
-    if(wic_focus)
+    if(wic_focus && !wic_replay_file)
     {
-        wic_cursor_location.x = x;
-        wic_cursor_location.y = y;
+        WicGame* game = glfwGetWindowUserPointer(window);
+        WicEvent event = {WIC_EVENT_CURSOR, glfwGetTime(), 0, 0,
+                          {x, game->dimensions.y - y}};
+        wic_apply_event(&event);
     }
 }
 void wic_mouse_button_callback(GLFWwindow* window, int button, int action,
                                int mods)
 {
-    if(wic_focus)
+    if(wic_focus && !wic_replay_file && button >= 0 &&
+       button + WIC_LMB < WIC_NUM_KEYS)
     {
-        if(action == GLFW_PRESS)
-            wic_down_keys[button + 350] = true;
-        else
-            wic_down_keys[button + 350] = false;
+        WicEvent event = {WIC_EVENT_KEY_PRESS, glfwGetTime(), button + WIC_LMB,
+                          0, {0,0}};
+        if(action == GLFW_RELEASE)
+            event.type = WIC_EVENT_KEY_RELEASE;
+        wic_apply_event(&event);
     }
 }
 void wic_scroll_callback(GLFWwindow* window, double x, double y)
 {
-    if(wic_focus)
+    if(wic_focus && !wic_replay_file)
     {
-        wic_scroll_offset.x = x;
-        wic_scroll_offset.y = y;
+        WicEvent event = {WIC_EVENT_SCROLL, glfwGetTime(), 0, 0, {x, y}};
+        wic_apply_event(&event);
     }
 }
-static bool wic_initialized = false;
-struct WicGame
-{
-    GLFWwindow* window;
-    WicPair dimensions;
-    WicPair pixel_density;
-    double seconds_per_frame;
-    double previous_time;
-    double delta;
-    FT_Library freetype_library;
-
-};
 WicGame* wic_init_game(const char* title, WicPair dimensions, unsigned fps,
-                       bool resizeable, bool fullscreen, unsigned samples)
+                       bool resizeable, bool fullscreen, unsigned samples,
+                       enum WicBackend backend)
 {
     if(wic_initialized)
         return (void*) wic_throw_error(WIC_ERRNO_ALREADY_INIT);
@@ -125,6 +230,13 @@ WicGame* wic_init_game(const char* title, WicPair dimensions, unsigned fps,
     glfwWindowHint(GLFW_REFRESH_RATE, fps);
     glfwWindowHint(GLFW_SAMPLES, samples);
     glfwWindowHint(GLFW_RESIZABLE, resizeable);
+    if(backend == WIC_BACKEND_CORE)
+    {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    }
     GLFWmonitor* monitor = glfwGetPrimaryMonitor();
     if(!monitor)
     {
@@ -147,20 +259,37 @@ WicGame* wic_init_game(const char* title, WicPair dimensions, unsigned fps,
     glfwSetKeyCallback(window, wic_key_callback);
     glfwSetCharCallback(window, wic_char_callback);
     glfwSetCursorPosCallback(window, wic_cursor_location_callback);
+    glfwSetMouseButtonCallback(window, wic_mouse_button_callback);
     glfwSetScrollCallback(window, wic_scroll_callback);
     glfwMakeContextCurrent(window);
     glfwSetTime(0.0);
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glDisable(GL_DEPTH_TEST);
+    if(!wic_init_renderer(backend, dimensions))
+    {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 0;
+    }
     FT_Library freetype_library;
     int error = FT_Init_FreeType(&freetype_library);
     if(error != 0)
     {
+        wic_free_renderer();
         glfwTerminate();
         glfwDestroyWindow(window);
         return (void*) wic_throw_error(WIC_ERRNO_FREETYPE_FAIL);
     }
+    unsigned* frame_histogram = calloc(WIC_NUM_BUCKETS, sizeof(unsigned));
+    if(!frame_histogram)
+    {
+        wic_free_renderer();
+        FT_Done_FreeType(freetype_library);
+        glfwTerminate();
+        glfwDestroyWindow(window);
+        return (void*) wic_throw_error(WIC_ERRNO_NO_HEAP);
+    }
     int physicalWidth; int physicalHeight;
     glfwGetMonitorPhysicalSize(monitor, &physicalWidth, &physicalHeight);
     const GLFWvidmode* mode = glfwGetVideoMode(monitor);
@@ -168,6 +297,9 @@ WicGame* wic_init_game(const char* title, WicPair dimensions, unsigned fps,
     WicGame* result = malloc(sizeof(WicGame));
     if(!result)
     {
+        wic_free_renderer();
+        free(frame_histogram);
+        FT_Done_FreeType(freetype_library);
         glfwTerminate();
         glfwDestroyWindow(window);
         return (void*) wic_throw_error(WIC_ERRNO_NO_HEAP);
@@ -180,32 +312,185 @@ WicGame* wic_init_game(const char* title, WicPair dimensions, unsigned fps,
     result->previous_time = 0.0;
     result->delta = 0.0;
     result->freetype_library = freetype_library;
+    result->pace_mode = WIC_PACE_ADAPTIVE;
+    result->next_frame_time = result->seconds_per_frame;
+    result->sleep_overshoot = WIC_SPIN_MARGIN / 2;
+    result->frame_histogram = frame_histogram;
+    result->num_frames = 0;
+    result->min_frame_time = 0.0;
+    result->total_frame_time = 0.0;
+    glfwSwapInterval(0);
+    glfwSetWindowUserPointer(window, result);
     wic_initialized = true;
     return result;
 }
+/* sets the swap interval of the current context */
+void wic_set_swap_interval(void* interval)
+{
+    glfwSwapInterval(*(int*) interval);
+}
+/* sleeps until shortly before the next frame deadline and spins the rest */
+void wic_wait_for_frame(WicGame* target)
+{
+    if(target->pace_mode == WIC_PACE_VSYNC)
+        return;
+    double margin = WIC_SPIN_MARGIN;
+    if(target->pace_mode == WIC_PACE_ADAPTIVE)
+        margin = target->sleep_overshoot * 1.25;
+    double start = glfwGetTime();
+    double sleep = target->next_frame_time - start - margin;
+    if(sleep > 0)
+    {
+        usleep(sleep * 1000000);
+        double overshoot = glfwGetTime() - start - sleep;
+        if(overshoot < 0)
+            overshoot = 0;
+        if(overshoot > target->sleep_overshoot)
+            target->sleep_overshoot += (overshoot-target->sleep_overshoot)/2;
+        else
+            target->sleep_overshoot += (overshoot-target->sleep_overshoot)/20;
+    }
+    while(glfwGetTime() < target->next_frame_time);
+    target->next_frame_time += target->seconds_per_frame;
+    double now = glfwGetTime();
+    if(target->next_frame_time < now)
+        target->next_frame_time = now + target->seconds_per_frame;
+}
+/* reads the clock and input events of the next replayed frame */
+bool wic_replay_frame(WicGame* target)
+{
+    uint8_t tag;
+    double clock[2];
+    if(fread(&tag, sizeof(tag), 1, wic_replay_file) != 1 ||
+       tag != WIC_LOG_FRAME ||
+       fread(clock, sizeof(double), 2, wic_replay_file) != 2)
+    {
+        wic_stop_replay();
+        return false;
+    }
+    wic_replay_time = clock[0];
+    target->delta = clock[1];
+    int c;
+    while((c = fgetc(wic_replay_file)) != EOF && c != WIC_LOG_FRAME)
+    {
+        WicEvent event;
+        if(!wic_read_event(wic_replay_file, c, &event))
+        {
+            wic_stop_replay();
+            return false;
+        }
+        wic_apply_event(&event);
+    }
+    if(c != EOF)
+        ungetc(c, wic_replay_file);
+    return true;
+}
+/* adds a frame time to the frame time histogram */
+void wic_record_frame(WicGame* target, double frame_time)
+{
+    unsigned bucket = frame_time / WIC_BUCKET_WIDTH;
+    if(bucket >= WIC_NUM_BUCKETS)
+        bucket = WIC_NUM_BUCKETS - 1;
+    target->frame_histogram[bucket]++;
+    if(!target->num_frames || frame_time < target->min_frame_time)
+        target->min_frame_time = frame_time;
+    target->total_frame_time += frame_time;
+    target->num_frames++;
+}
 unsigned wic_updt_game(WicGame* target)
 {
     if(!target)
         return wic_throw_error(WIC_ERRNO_NULL_TARGET);
     if(!glfwWindowShouldClose(target->window))
     {
-        float delay = target->seconds_per_frame -
-                       (glfwGetTime() - target->previous_time);
-        if(delay > 0)
-            usleep(delay * 1000);
-        wic_reset_input();
-        glfwSwapBuffers(target->window);
-        glFlush();
-        glClearColor(0.0,0.0,0.0,1.0);
-        glClear(GL_COLOR_BUFFER_BIT);
-        glLoadIdentity();
-        target->delta = glfwGetTime() - target->previous_time;
-        target->previous_time = glfwGetTime();
+        wic_updt_textures();
+        WIC_PROFILE_BEGIN("sleep");
+        if(!wic_replay_file || wic_replay_paced)
+            wic_wait_for_frame(target);
+        WIC_PROFILE_END("sleep");
+        if(!wic_input_latched)
+            wic_reset_input();
+        wic_render_end_frame();
+        if(wic_render_is_threaded())
+        {
+            WIC_PROFILE_BEGIN("submit");
+            wic_render_submit();
+            WIC_PROFILE_END("submit");
+            WIC_PROFILE_FRAME();
+        }
+        else
+        {
+            wic_render_submit();
+            WIC_PROFILE_BEGIN("swap");
+            glfwSwapBuffers(target->window);
+            glFlush();
+            WIC_PROFILE_END("swap");
+            WIC_PROFILE_FRAME();
+            WIC_PROFILE_BEGIN("clear");
+            wic_render_begin_frame();
+            WIC_PROFILE_END("clear");
+        }
+        double now = glfwGetTime();
+        target->delta = now - target->previous_time;
+        target->previous_time = now;
+        wic_record_frame(target, target->delta);
+        WIC_PROFILE_COUNT("frame time (ms)", target->delta * 1000);
+        if(wic_replay_file)
+            wic_replay_frame(target);
+        else if(wic_record_file)
+        {
+            double clock[2] = {now, target->delta};
+            fwrite(&WIC_LOG_FRAME, sizeof(WIC_LOG_FRAME), 1, wic_record_file);
+            fwrite(clock, sizeof(double), 2, wic_record_file);
+        }
+        WIC_PROFILE_BEGIN("glfwPollEvents");
         glfwPollEvents();
+        WIC_PROFILE_END("glfwPollEvents");
         return WIC_GAME_CONTINUE;
     }
     return WIC_GAME_TERMINATE;
 }
+bool wic_run_game(WicGame* target, unsigned tick_rate, unsigned max_ticks,
+                  WicTickCallback tick, WicRenderCallback render, void* data)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!tick_rate)
+        return wic_throw_error(WIC_ERRNO_SMALL_TICK_RATE);
+    if(!max_ticks)
+        return wic_throw_error(WIC_ERRNO_SMALL_MAX_TICKS);
+    if(!tick)
+        return wic_throw_error(WIC_ERRNO_NULL_CALLBACK);
+    double tick_time = 1.0 / tick_rate;
+    double accumulator = 0.0;
+    double previous_time = wic_get_time();
+    unsigned status;
+    wic_input_latched = true;
+    do
+    {
+        double now = wic_get_time();
+        accumulator += now - previous_time;
+        previous_time = now;
+        unsigned ticks = 0;
+        while(accumulator >= tick_time && ticks < max_ticks)
+        {
+            tick(target, tick_time, data);
+            /* input stays latched through frames without ticks and is seen
+               by only the first tick of a frame */
+            wic_reset_input();
+            accumulator -= tick_time;
+            ticks++;
+        }
+        if(accumulator >= tick_time)
+            accumulator = fmod(accumulator, tick_time);
+        if(render)
+            render(target, accumulator / tick_time, data);
+        status = wic_updt_game(target);
+    }
+    while(status == WIC_GAME_CONTINUE);
+    wic_input_latched = false;
+    return status == WIC_GAME_TERMINATE;
+}
 bool wic_exit_game(WicGame* target)
 {
     if(!target)
@@ -213,6 +498,68 @@ bool wic_exit_game(WicGame* target)
     glfwSetWindowShouldClose(target->window, true);
     return true;
 }
+bool wic_set_pace_mode(WicGame* target, enum WicPaceMode mode)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    target->pace_mode = mode;
+    target->next_frame_time = glfwGetTime() + target->seconds_per_frame;
+    int interval = mode == WIC_PACE_VSYNC;
+    wic_render_call(wic_set_swap_interval, &interval);
+    return true;
+}
+bool wic_set_render_thread(WicGame* target, bool enabled)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!enabled)
+    {
+        wic_stop_render_thread();
+        return true;
+    }
+    if(!wic_start_render_thread(target->window))
+        return false;
+    int interval = target->pace_mode == WIC_PACE_VSYNC;
+    wic_render_call(wic_set_swap_interval, &interval);
+    return true;
+}
+WicFrameStats wic_get_frame_stats(WicGame* target)
+{
+    WicFrameStats result = {0.0, 0.0, 0.0, 0};
+    if(!target)
+    {
+        wic_throw_error(WIC_ERRNO_NULL_TARGET);
+        return result;
+    }
+    if(!target->num_frames)
+        return result;
+    result.min = target->min_frame_time;
+    result.mean = target->total_frame_time / target->num_frames;
+    result.num_frames = target->num_frames;
+    unsigned threshold = target->num_frames - target->num_frames / 100;
+    unsigned count = 0;
+    unsigned bucket = 0;
+    while((count += target->frame_histogram[bucket]) < threshold)
+        bucket++;
+    result.p99 = (bucket + 1) * WIC_BUCKET_WIDTH;
+    return result;
+}
+bool wic_reset_frame_stats(WicGame* target)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    memset(target->frame_histogram, 0, WIC_NUM_BUCKETS * sizeof(unsigned));
+    target->num_frames = 0;
+    target->min_frame_time = 0.0;
+    target->total_frame_time = 0.0;
+    return true;
+}
+unsigned wic_get_num_culled(WicGame* target)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    return wic_render_get_num_culled();
+}
 double wic_get_delta(WicGame* target)
 {
     if(!target)
@@ -226,10 +573,14 @@ bool wic_free_game(WicGame* target)
 {
     if(!target)
         return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    wic_free_renderer();
     glfwDestroyWindow(target->window);
     glfwTerminate();
+    free(target->frame_histogram);
     
     target->window = 0;
+    target->frame_histogram = 0;
+    target->num_frames = 0;
     target->dimensions = (WicPair) {0,0};
     target->seconds_per_frame = 0.0;
     target->previous_time = 0.0;
@@ -239,11 +590,102 @@ bool wic_free_game(WicGame* target)
 }
 bool wic_is_key_down(enum WicKey key)
 {
-    return wic_down_keys[(int) key];
+    unsigned index = key;
+    if(index >= WIC_NUM_KEYS)
+        return false;
+    return wic_down_keys[index / 32] >> index % 32 & 1;
 }
 bool wic_is_key_pressed(enum WicKey key)
 {
-    return wic_pressed_keys[(int) key];
+    unsigned index = key;
+    if(index >= WIC_NUM_KEYS)
+        return false;
+    return wic_pressed_keys[index / 32] >> index % 32 & 1;
+}
+bool wic_poll_event(WicEvent* result)
+{
+    if(!result)
+        return wic_throw_error(WIC_ERRNO_NULL_RESULT);
+    unsigned tail = wic_event_tail;
+    if(tail == __atomic_load_n(&wic_event_head, __ATOMIC_ACQUIRE))
+        return false;
+    *result = wic_events[tail % WIC_EVENT_CAPACITY];
+    __atomic_store_n(&wic_event_tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+bool wic_start_recording(const char* filepath)
+{
+    if(!filepath)
+        return wic_throw_error(WIC_ERRNO_NULL_FILEPATH);
+    if(wic_record_file || wic_replay_file)
+        return wic_throw_error(WIC_ERRNO_ALREADY_RECORDING);
+    FILE* file = fopen(filepath, "wb");
+    if(!file)
+        return wic_throw_error(WIC_ERRNO_WRITE_FILE_FAIL);
+    fwrite(WIC_LOG_MAGIC, sizeof(WIC_LOG_MAGIC), 1, file);
+    fwrite(&WIC_LOG_VERSION, sizeof(WIC_LOG_VERSION), 1, file);
+    fwrite(wic_down_keys, sizeof(wic_down_keys), 1, file);
+    fwrite(&wic_cursor_location, sizeof(wic_cursor_location), 1, file);
+    if(ferror(file))
+    {
+        fclose(file);
+        return wic_throw_error(WIC_ERRNO_WRITE_FILE_FAIL);
+    }
+    wic_record_file = file;
+    return true;
+}
+bool wic_stop_recording()
+{
+    if(!wic_record_file)
+        return wic_throw_error(WIC_ERRNO_NOT_RECORDING);
+    bool failed = ferror(wic_record_file);
+    failed |= fclose(wic_record_file) != 0;
+    wic_record_file = 0;
+    if(failed)
+        return wic_throw_error(WIC_ERRNO_WRITE_FILE_FAIL);
+    return true;
+}
+bool wic_start_replay(const char* filepath, bool paced)
+{
+    if(!filepath)
+        return wic_throw_error(WIC_ERRNO_NULL_FILEPATH);
+    if(wic_record_file || wic_replay_file)
+        return wic_throw_error(WIC_ERRNO_ALREADY_RECORDING);
+    FILE* file = fopen(filepath, "rb");
+    if(!file)
+        return wic_throw_error(WIC_ERRNO_LOAD_FILE_FAIL);
+    char magic[sizeof(WIC_LOG_MAGIC)];
+    uint32_t version;
+    uint32_t down_keys[sizeof(wic_down_keys) / sizeof(uint32_t)];
+    WicPair cursor_location;
+    if(fread(magic, sizeof(magic), 1, file) != 1 ||
+       memcmp(magic, WIC_LOG_MAGIC, sizeof(magic)) ||
+       fread(&version, sizeof(version), 1, file) != 1 ||
+       version != WIC_LOG_VERSION ||
+       fread(down_keys, sizeof(down_keys), 1, file) != 1 ||
+       fread(&cursor_location, sizeof(cursor_location), 1, file) != 1)
+    {
+        fclose(file);
+        return wic_throw_error(WIC_ERRNO_INVALID_LOG);
+    }
+    memcpy(wic_down_keys, down_keys, sizeof(wic_down_keys));
+    wic_cursor_location = cursor_location;
+    wic_replay_file = file;
+    wic_replay_paced = paced;
+    wic_replay_time = glfwGetTime();
+    return true;
+}
+bool wic_stop_replay()
+{
+    if(!wic_replay_file)
+        return wic_throw_error(WIC_ERRNO_NOT_REPLAYING);
+    fclose(wic_replay_file);
+    wic_replay_file = 0;
+    return true;
+}
+bool wic_is_replaying()
+{
+    return wic_replay_file != 0;
 }
 unsigned char* wic_get_input()
 {
@@ -251,9 +693,7 @@ unsigned char* wic_get_input()
 }
 WicPair wic_get_cursor_location(WicGame* game)
 {
-    WicPair result = wic_cursor_location;
-    result.y = game->dimensions.y - result.y;
-    return result;
+    return wic_cursor_location;
 }
 WicPair wic_get_scroll_offset()
 {
@@ -261,6 +701,8 @@ WicPair wic_get_scroll_offset()
 }
 double wic_get_time()
 {
+    if(wic_replay_file)
+        return wic_replay_time;
     return glfwGetTime();
 }
 WicPair wic_convert_location(WicPair location, WicPair dimensions)
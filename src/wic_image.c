@@ -23,6 +23,8 @@ struct WicTexture
 {
     unsigned int data;
     WicPair dimensions;
+    unsigned channels;
+    enum WicTextureStatus status;
 };
 struct WicGame
 {
@@ -33,8 +35,48 @@ struct WicGame
     double previous_time;
     double delta;
     FT_Library freetype_library;
+    enum WicPaceMode pace_mode;
+    double next_frame_time;
+    double sleep_overshoot;
+    unsigned* frame_histogram;
+    unsigned num_frames;
+    double min_frame_time;
+    double total_frame_time;
     
 };
+typedef struct WicVertex
+{
+    GLfloat x;
+    GLfloat y;
+    GLfloat u;
+    GLfloat v;
+    WicColor color;
+} WicVertex;
+typedef struct WicInstance
+{
+    GLfloat x;
+    GLfloat y;
+    GLfloat center_x;
+    GLfloat center_y;
+    GLfloat width;
+    GLfloat height;
+    GLfloat scale_x;
+    GLfloat scale_y;
+    GLfloat rotation;
+    GLfloat u0;
+    GLfloat v0;
+    GLfloat u1;
+    GLfloat v1;
+    WicColor color;
+} WicInstance;
+bool wic_render_is_recording();
+bool wic_render_is_core();
+WicVertex* wic_render_add(unsigned texture, GLenum mode, unsigned num_vertices);
+WicInstance* wic_render_add_instances(unsigned texture, unsigned num_instances);
+void wic_render_submit();
+void wic_render_trim(unsigned count);
+bool wic_render_cull(WicBounds bounds);
+bool wic_render_is_offscreen(WicBounds bounds);
 bool wic_init_image(WicImage* target, WicPair location, WicTexture* texture)
 {
     if(!target)
@@ -63,71 +105,180 @@ WicPair wic_image_get_geo_center(WicImage* target)
                                           target->bounds.lower_left);
     return wic_divide_pairs(diagonal, (WicPair) {2,2});
 }
+void wic_image_get_quad(WicImage* target, WicPair* vertices,
+                        WicPair* tex_coords)
+{
+    WicPair tex_dimensions = target->texture->dimensions;
+    WicPair diagonal = wic_subtract_pairs(target->bounds.upper_right,
+                                          target->bounds.lower_left);
+    /* lower left, lower right, upper right, and upper left corners */
+    vertices[0] = (WicPair) {0,0};
+    vertices[1] = (WicPair) {diagonal.x, 0};
+    vertices[2] = diagonal;
+    vertices[3] = (WicPair) {0, diagonal.y};
+    tex_coords[0] = target->bounds.lower_left;
+    tex_coords[1] = (WicPair) {target->bounds.upper_right.x,
+                               target->bounds.lower_left.y};
+    tex_coords[2] = target->bounds.upper_right;
+    tex_coords[3] = (WicPair) {target->bounds.lower_left.x,
+                               target->bounds.upper_right.y};
+    WicTransform transform = wic_get_transform(target->location,
+                                               target->center,
+                                               target->rotation, target->scale,
+                                               target->draw_centered);
+    wic_transform_pairs(transform, vertices, vertices, 4);
+    for(unsigned i = 0; i < 4; i++)
+        tex_coords[i] = wic_divide_pairs(tex_coords[i], tex_dimensions);
+}
+/* computes screen bounds that contain a WicImage */
+WicBounds wic_image_get_bounds(WicImage* target)
+{
+    WicPair diagonal = wic_subtract_pairs(target->bounds.upper_right,
+                                          target->bounds.lower_left);
+    return wic_get_drawable_bounds(target->location, target->center,
+                                   target->rotation, target->scale,
+                                   target->draw_centered,
+                                   (WicBounds) {(WicPair) {0,0}, diagonal});
+}
+/* fills the unit quad instance of a WicImage */
+void wic_image_get_instance(WicImage* target, WicInstance* instance)
+{
+    WicPair tex_dimensions = target->texture->dimensions;
+    WicPair diagonal = wic_subtract_pairs(target->bounds.upper_right,
+                                          target->bounds.lower_left);
+    WicPair offset = target->location;
+    if(!target->draw_centered)
+        offset = wic_add_pairs(offset, target->center);
+    *instance = (WicInstance) {offset.x, offset.y, target->center.x,
+                               target->center.y, diagonal.x, diagonal.y,
+                               target->scale.x, target->scale.y,
+                               target->rotation,
+                               target->bounds.lower_left.x / tex_dimensions.x,
+                               target->bounds.lower_left.y / tex_dimensions.y,
+                               target->bounds.upper_right.x / tex_dimensions.x,
+                               target->bounds.upper_right.y / tex_dimensions.y,
+                               target->color};
+}
+/* records a run of WicImages sharing a texture */
+bool wic_image_add_run(WicImage* targets, unsigned num_targets, bool core)
+{
+    unsigned texture = targets[0].texture->data;
+    unsigned num_visible = 0;
+    if(core)
+    {
+        WicInstance* instances = wic_render_add_instances(texture,
+                                                          num_targets);
+        for(unsigned i = 0; instances && i < num_targets; i++)
+        {
+            if(!wic_render_cull(wic_image_get_bounds(&targets[i])))
+                wic_image_get_instance(&targets[i], &instances[num_visible++]);
+        }
+        if(instances)
+            wic_render_trim(num_targets - num_visible);
+        return instances != 0;
+    }
+    WicVertex* packet_vertices = wic_render_add(texture, GL_QUADS,
+                                                num_targets * 4);
+    for(unsigned i = 0; packet_vertices && i < num_targets; i++)
+    {
+        if(wic_render_cull(wic_image_get_bounds(&targets[i])))
+            continue;
+        WicPair vertices[4];
+        WicPair tex_coords[4];
+        wic_image_get_quad(&targets[i], vertices, tex_coords);
+        for(unsigned j = 0; j < 4; j++)
+            packet_vertices[num_visible * 4 + j] = (WicVertex)
+                {vertices[j].x, vertices[j].y, tex_coords[j].x,
+                 tex_coords[j].y, targets[i].color};
+        num_visible++;
+    }
+    if(packet_vertices)
+        wic_render_trim((num_targets - num_visible) * 4);
+    return packet_vertices != 0;
+}
 bool wic_draw_image(WicImage* target, WicGame* game)
 {
     if(!target)
         return wic_throw_error(WIC_ERRNO_NULL_TARGET);
     if(!game)
         return wic_throw_error(WIC_ERRNO_NULL_GAME);
-    WicPair window_dimensions = game->dimensions;
-    WicPair tex_dimensions = target->texture->dimensions;
+    if(target->texture->status != WIC_TEXTURE_READY ||
+       wic_render_cull(wic_image_get_bounds(target)))
+        return true;
+    WIC_PROFILE_BEGIN("wic_draw_image");
+    WicPair vertices[4];
+    WicPair tex_coords[4];
+    wic_image_get_quad(target, vertices, tex_coords);
+    if(wic_render_is_recording())
+    {
+        WicVertex* packet_vertices = wic_render_add(target->texture->data,
+                                                    GL_QUADS, 4);
+        if(packet_vertices)
+        {
+            for(unsigned i = 0; i < 4; i++)
+                packet_vertices[i] = (WicVertex) {vertices[i].x, vertices[i].y,
+                                                  tex_coords[i].x,
+                                                  tex_coords[i].y,
+                                                  target->color};
+        }
+        WIC_PROFILE_END("wic_draw_image");
+        return packet_vertices != 0;
+    }
     glBindTexture(GL_TEXTURE_2D, target->texture->data);
     glColor4ub(target->color.red, target->color.green, target->color.blue,
                target->color.alpha);
     glEnable(GL_TEXTURE_2D);
     glBegin(GL_QUADS);
-        
-    /* lower left corner */
-    WicPair vertex = {0,0};
-    vertex = wic_transform_pair(vertex, target->rotation, target->scale,
-                                target->center);
-    if(!target->draw_centered)
-        vertex = wic_add_pairs(vertex, target->center);
-    
-    vertex = wic_convert_location(wic_add_pairs(vertex, target->location),
-                                  window_dimensions);
-    glTexCoord2f(target->bounds.lower_left.x / tex_dimensions.x,
-                 target->bounds.lower_left.y / tex_dimensions.y);
-    glVertex2d(vertex.x, vertex.y);
-    /* lower right corner */
-    vertex = (WicPair) {target->bounds.upper_right.x -
-                        target->bounds.lower_left.x, 0};
-
-    vertex = wic_transform_pair(vertex, target->rotation, target->scale,
-                                target->center);
-    if(!target->draw_centered)
-        vertex = wic_add_pairs(vertex, target->center);
-    vertex = wic_convert_location(wic_add_pairs(vertex, target->location),
-                              window_dimensions);
-    glTexCoord2f(target->bounds.upper_right.x / tex_dimensions.x,
-                 target->bounds.lower_left.y / tex_dimensions.y);
-    glVertex2d(vertex.x, vertex.y);
-    /* upper right corner */
-    vertex = wic_subtract_pairs(target->bounds.upper_right,
-                                target->bounds.lower_left);
-    vertex = wic_transform_pair(vertex, target->rotation, target->scale,
-                                target->center);
-    if(!target->draw_centered)
-        vertex = wic_add_pairs(vertex, target->center);
-    vertex = wic_convert_location(wic_add_pairs(vertex, target->location),
-                              window_dimensions);
-    glTexCoord2f(target->bounds.upper_right.x / tex_dimensions.x,
-                 target->bounds.upper_right.y / tex_dimensions.y);
-    glVertex2d(vertex.x, vertex.y);
-    /* upper left corner */
-    vertex = (WicPair) {0, target->bounds.upper_right.y -
-                           target->bounds.lower_left.y};
-    vertex = wic_transform_pair(vertex, target->rotation, target->scale,
-                                target->center);
-    if(!target->draw_centered)
-        vertex = wic_add_pairs(vertex, target->center);
-    vertex = wic_convert_location(wic_add_pairs(vertex, target->location),
-                                  window_dimensions);
-    glTexCoord2f(target->bounds.lower_left.x / tex_dimensions.x,
-                 target->bounds.upper_right.y / tex_dimensions.y);
-    glVertex2d(vertex.x, vertex.y);
-        
+    for(unsigned i = 0; i < 4; i++)
+    {
+        glTexCoord2f(tex_coords[i].x, tex_coords[i].y);
+        glVertex2d(vertices[i].x, vertices[i].y);
+    }
     glEnd();
     glDisable(GL_TEXTURE_2D);
-        return true;
+    WIC_PROFILE_END("wic_draw_image");
+    return true;
+}
+bool wic_draw_images(WicImage* targets, unsigned num_targets, WicGame* game)
+{
+    if(!targets)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!game)
+        return wic_throw_error(WIC_ERRNO_NULL_GAME);
+    WIC_PROFILE_BEGIN("wic_draw_images");
+    bool core = wic_render_is_core();
+    bool success = true;
+    unsigned i = 0;
+    while(success && i < num_targets)
+    {
+        WicTexture* texture = targets[i].texture;
+        unsigned run = 1;
+        while(i + run < num_targets && targets[i + run].texture == texture)
+            run++;
+        if(texture->status == WIC_TEXTURE_READY)
+            success = wic_image_add_run(&targets[i], run, core);
+        i += run;
+    }
+    if(success && !core && !wic_render_is_recording())
+        wic_render_submit();
+    WIC_PROFILE_END("wic_draw_images");
+    return success;
+}
+unsigned wic_cull_images(WicImage* targets, unsigned num_targets,
+                         bool* visible, WicGame* game)
+{
+    if(!targets)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!visible)
+        return wic_throw_error(WIC_ERRNO_NULL_RESULT);
+    if(!game)
+        return wic_throw_error(WIC_ERRNO_NULL_GAME);
+    unsigned result = 0;
+    for(unsigned i = 0; i < num_targets; i++)
+    {
+        WicBounds bounds = wic_image_get_bounds(&targets[i]);
+        visible[i] = !wic_render_is_offscreen(bounds);
+        result += visible[i];
+    }
+    return result;
 }
@@ -0,0 +1,343 @@
+/* ----------------------------------------------------------------------------
+ * wic - a simple 2D game engine for Mac OSX written in C
+ * Copyright (C) 2013-2017  Willis O'Leary
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * ----------------------------------------------------------------------------
+ * File:    wic_jobs.c
+ * ----------------------------------------------------------------------------
+ */
+#include "wic_jobs.h"
+#define WIC_DEQUE_CAPACITY 4096
+typedef struct WicJob
+{
+    WicJobFunction function; /**< the function to run */
+    void* data;              /**< the user data passed to function */
+    WicCounter* counter;     /**< the counter to decrement, may be null */
+} WicJob;
+typedef struct WicDeque
+{
+    WicJob jobs[WIC_DEQUE_CAPACITY]; /**< the jobs, indexed modulo capacity */
+    long top;                        /**< the index thieves steal from */
+    long bottom;                     /**< the index the owner pushes to */
+} WicDeque;
+typedef struct WicRange
+{
+    WicRangeFunction function; /**< the function to call on each chunk */
+    void* data;                /**< the user data passed to function */
+    unsigned count;            /**< the number of indices */
+    unsigned grain;            /**< the number of indices per chunk */
+    uint64_t next;             /**< the first unclaimed index */
+} WicRange;
+static pthread_mutex_t wic_jobs_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wic_jobs_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t* wic_workers = 0;
+static WicDeque* wic_deques = 0;
+static unsigned wic_num_workers = 0;
+static unsigned wic_num_threads = 0;
+static bool wic_jobs_stopping = false;
+static WicJob* wic_shared_jobs = 0;
+static unsigned wic_shared_head = 0;
+static unsigned wic_num_shared_jobs = 0;
+static unsigned wic_max_shared_jobs = 0;
+static unsigned wic_num_queued = 0;
+static unsigned wic_num_sleeping = 0;
+static __thread WicDeque* wic_own_deque = 0;
+static __thread unsigned wic_steal_index = 0;
+bool wic_deque_push(WicDeque* deque, WicJob* job)
+{
+    long bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+    long top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+    if(bottom - top >= WIC_DEQUE_CAPACITY)
+        return false;
+    deque->jobs[bottom % WIC_DEQUE_CAPACITY] = *job;
+    __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELEASE);
+    return true;
+}
+bool wic_deque_pop(WicDeque* deque, WicJob* result)
+{
+    long bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&deque->bottom, bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    long top = __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+    if(top > bottom)
+    {
+        __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+        return false;
+    }
+    *result = deque->jobs[bottom % WIC_DEQUE_CAPACITY];
+    if(top == bottom)
+    {
+        /* the last job may be being stolen, so race the thieves for it */
+        bool won = __atomic_compare_exchange_n(&deque->top, &top, top + 1,
+                                               false, __ATOMIC_SEQ_CST,
+                                               __ATOMIC_RELAXED);
+        __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+        return won;
+    }
+    return true;
+}
+bool wic_deque_steal(WicDeque* deque, WicJob* result)
+{
+    long top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    long bottom = __atomic_load_n(&deque->bottom, __ATOMIC_ACQUIRE);
+    if(top >= bottom)
+        return false;
+    *result = deque->jobs[top % WIC_DEQUE_CAPACITY];
+    return __atomic_compare_exchange_n(&deque->top, &top, top + 1, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+/* takes a job from the calling worker, the shared queue, or another worker */
+bool wic_find_job(WicJob* result)
+{
+    bool found = wic_own_deque && wic_deque_pop(wic_own_deque, result);
+    if(!found && __atomic_load_n(&wic_num_shared_jobs, __ATOMIC_RELAXED))
+    {
+        pthread_mutex_lock(&wic_jobs_mutex);
+        if(wic_num_shared_jobs)
+        {
+            *result = wic_shared_jobs[wic_shared_head];
+            wic_shared_head = (wic_shared_head + 1) % wic_max_shared_jobs;
+            __atomic_sub_fetch(&wic_num_shared_jobs, 1, __ATOMIC_RELAXED);
+            found = true;
+        }
+        pthread_mutex_unlock(&wic_jobs_mutex);
+    }
+    for(unsigned i = 0; i < wic_num_workers && !found; i++)
+    {
+        WicDeque* victim = &wic_deques[wic_steal_index++ % wic_num_workers];
+        if(victim != wic_own_deque)
+            found = wic_deque_steal(victim, result);
+    }
+    if(found)
+        __atomic_sub_fetch(&wic_num_queued, 1, __ATOMIC_SEQ_CST);
+    return found;
+}
+void wic_run_job(WicJob* job)
+{
+    job->function(job->data);
+    if(job->counter)
+        __atomic_sub_fetch(&job->counter->pending, 1, __ATOMIC_RELEASE);
+}
+/* runs jobs until the job system is freed, sleeping whenever none are queued */
+void* wic_run_worker(void* deque)
+{
+    wic_own_deque = deque;
+    wic_steal_index = wic_own_deque - wic_deques + 1;
+    while(true)
+    {
+        WicJob job;
+        if(wic_find_job(&job))
+        {
+            wic_run_job(&job);
+            continue;
+        }
+        pthread_mutex_lock(&wic_jobs_mutex);
+        __atomic_add_fetch(&wic_num_sleeping, 1, __ATOMIC_SEQ_CST);
+        while(!__atomic_load_n(&wic_num_queued, __ATOMIC_SEQ_CST) &&
+              !wic_jobs_stopping)
+            pthread_cond_wait(&wic_jobs_cond, &wic_jobs_mutex);
+        __atomic_sub_fetch(&wic_num_sleeping, 1, __ATOMIC_SEQ_CST);
+        bool stop = wic_jobs_stopping &&
+                    !__atomic_load_n(&wic_num_queued, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&wic_jobs_mutex);
+        if(stop)
+            break;
+    }
+    return 0;
+}
+bool wic_init_jobs(unsigned num_workers)
+{
+    if(wic_num_workers)
+        return wic_throw_error(WIC_ERRNO_ALREADY_INIT);
+    if(!num_workers)
+    {
+        long num_cores = sysconf(_SC_NPROCESSORS_ONLN);
+        num_workers = num_cores > 2 ? num_cores - 1 : 1;
+    }
+    wic_workers = malloc(num_workers * sizeof(pthread_t));
+    wic_deques = calloc(num_workers, sizeof(WicDeque));
+    if(!wic_workers || !wic_deques)
+    {
+        free(wic_workers);
+        free(wic_deques);
+        return wic_throw_error(WIC_ERRNO_NO_HEAP);
+    }
+    wic_jobs_stopping = false;
+    /* set before any worker starts stealing; deques of threads that fail to
+     * start simply stay empty */
+    wic_num_workers = num_workers;
+    for(; wic_num_threads < num_workers; wic_num_threads++)
+    {
+        if(pthread_create(&wic_workers[wic_num_threads], 0, wic_run_worker,
+                          &wic_deques[wic_num_threads]))
+            break;
+    }
+    if(!wic_num_threads)
+    {
+        wic_num_workers = 0;
+        free(wic_workers);
+        free(wic_deques);
+        return wic_throw_error(WIC_ERRNO_THREAD_FAIL);
+    }
+    return true;
+}
+unsigned wic_get_num_workers()
+{
+    if(!wic_num_workers && !wic_init_jobs(0))
+        return 0;
+    return wic_num_workers;
+}
+bool wic_init_counter(WicCounter* target)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    target->pending = 0;
+    return true;
+}
+/* appends a job to the shared queue, growing it if necessary */
+bool wic_push_shared_job(WicJob* job)
+{
+    pthread_mutex_lock(&wic_jobs_mutex);
+    if(wic_num_shared_jobs == wic_max_shared_jobs)
+    {
+        unsigned max_jobs = wic_max_shared_jobs ? wic_max_shared_jobs * 2 : 256;
+        WicJob* jobs = malloc(max_jobs * sizeof(WicJob));
+        if(!jobs)
+        {
+            pthread_mutex_unlock(&wic_jobs_mutex);
+            return wic_throw_error(WIC_ERRNO_NO_HEAP);
+        }
+        for(unsigned i = 0; i < wic_num_shared_jobs; i++)
+            jobs[i] = wic_shared_jobs[(wic_shared_head + i) %
+                                      wic_max_shared_jobs];
+        free(wic_shared_jobs);
+        wic_shared_jobs = jobs;
+        wic_shared_head = 0;
+        wic_max_shared_jobs = max_jobs;
+    }
+    wic_shared_jobs[(wic_shared_head + wic_num_shared_jobs) %
+                    wic_max_shared_jobs] = *job;
+    __atomic_add_fetch(&wic_num_shared_jobs, 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&wic_jobs_mutex);
+    return true;
+}
+bool wic_submit_job(WicJobFunction function, void* data, WicCounter* counter)
+{
+    if(!function)
+        return wic_throw_error(WIC_ERRNO_NULL_CALLBACK);
+    if(!wic_num_workers && !wic_init_jobs(0))
+        return false;
+    WicJob job = {function, data, counter};
+    if(counter)
+        __atomic_add_fetch(&counter->pending, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&wic_num_queued, 1, __ATOMIC_SEQ_CST);
+    if(!(wic_own_deque && wic_deque_push(wic_own_deque, &job)) &&
+       !wic_push_shared_job(&job))
+    {
+        __atomic_sub_fetch(&wic_num_queued, 1, __ATOMIC_SEQ_CST);
+        if(counter)
+            __atomic_sub_fetch(&counter->pending, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+    if(__atomic_load_n(&wic_num_sleeping, __ATOMIC_SEQ_CST))
+    {
+        pthread_mutex_lock(&wic_jobs_mutex);
+        pthread_cond_signal(&wic_jobs_cond);
+        pthread_mutex_unlock(&wic_jobs_mutex);
+    }
+    return true;
+}
+bool wic_is_counter_done(WicCounter* target)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    return !__atomic_load_n(&target->pending, __ATOMIC_ACQUIRE);
+}
+bool wic_wait_counter(WicCounter* target)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    WIC_PROFILE_BEGIN("wic_wait_counter");
+    while(__atomic_load_n(&target->pending, __ATOMIC_ACQUIRE))
+    {
+        WicJob job;
+        if(wic_find_job(&job))
+            wic_run_job(&job);
+        else
+            sched_yield();
+    }
+    WIC_PROFILE_END("wic_wait_counter");
+    return true;
+}
+/* claims and processes chunks of a range until none are left */
+void wic_run_range(void* argument)
+{
+    WicRange* range = argument;
+    uint64_t start;
+    while((start = __atomic_fetch_add(&range->next, range->grain,
+                                      __ATOMIC_RELAXED)) < range->count)
+    {
+        uint64_t end = start + range->grain;
+        range->function(start, end < range->count ? end : range->count,
+                        range->data);
+    }
+}
+bool wic_parallel_for(unsigned count, unsigned grain,
+                      WicRangeFunction function, void* data)
+{
+    if(!function)
+        return wic_throw_error(WIC_ERRNO_NULL_CALLBACK);
+    if(!count)
+        return true;
+    unsigned num_workers = wic_get_num_workers();
+    if(!num_workers)
+        return false;
+    if(!grain)
+        grain = count / (4 * (num_workers + 1)) + 1;
+    WicRange range = {function, data, count, grain, 0};
+    WicCounter counter = {0};
+    unsigned num_chunks = (count - 1) / grain + 1;
+    for(unsigned i = 1; i < num_chunks && i <= num_workers; i++)
+    {
+        if(!wic_submit_job(wic_run_range, &range, &counter))
+            break;
+    }
+    wic_run_range(&range);
+    return wic_wait_counter(&counter);
+}
+bool wic_free_jobs()
+{
+    if(!wic_num_workers)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    pthread_mutex_lock(&wic_jobs_mutex);
+    wic_jobs_stopping = true;
+    pthread_cond_broadcast(&wic_jobs_cond);
+    pthread_mutex_unlock(&wic_jobs_mutex);
+    for(unsigned i = 0; i < wic_num_threads; i++)
+        pthread_join(wic_workers[i], 0);
+    free(wic_workers);
+    free(wic_deques);
+    free(wic_shared_jobs);
+    wic_workers = 0;
+    wic_deques = 0;
+    wic_shared_jobs = 0;
+    wic_shared_head = 0;
+    wic_num_shared_jobs = 0;
+    wic_max_shared_jobs = 0;
+    wic_num_workers = 0;
+    wic_num_threads = 0;
+    return true;
+}
@@ -40,8 +40,14 @@ const uint8_t WIC_PACKET_CLIENT_LEFT_BANNED = 2;
 
 const WicPacketType WIC_PACKET_SERVER_SHUTDOWN = {8,0};
 
+const WicPacketType WIC_PACKET_CHANNEL = {9, 9};
+const WicPacketType WIC_PACKET_ACK = {10, 7};
+const WicPacketType WIC_PACKET_SNAPSHOT = {11, 255};
+const WicPacketType WIC_PACKET_SNAPSHOT_ACK = {12, 3};
+
 const size_t WIC_PACKET_HEADER_SIZE = sizeof(WicNodeIndex) +
                                       sizeof(WicPacketType);
+const size_t WIC_MAX_DATAGRAM_SIZE = 1200;
 bool wic_get_packet_from_buffer(uint8_t* buffer, WicPacket* result)
 {
     if(!buffer)
@@ -54,6 +60,24 @@ bool wic_get_packet_from_buffer(uint8_t* buffer, WicPacket* result)
     bzero(result->data + result->type.size, 255 - result->type.size);
     return true;
 }
+bool wic_get_packet_from_datagram(uint8_t* datagram, size_t len_datagram,
+                                  size_t* offset, WicPacket* result)
+{
+    if(!datagram)
+        return wic_throw_error(WIC_ERRNO_NULL_BUFFER);
+    if(!offset || !result)
+        return wic_throw_error(WIC_ERRNO_NULL_RESULT);
+    
+    /* the payload size is the last byte of the header */
+    size_t remaining = len_datagram - *offset;
+    if(*offset >= len_datagram || remaining < WIC_PACKET_HEADER_SIZE ||
+       remaining < WIC_PACKET_HEADER_SIZE +
+                   datagram[*offset + WIC_PACKET_HEADER_SIZE - 1])
+        return wic_throw_error(WIC_ERRNO_MALFORMED_DATAGRAM);
+    wic_get_packet_from_buffer(datagram + *offset, result);
+    *offset += WIC_PACKET_HEADER_SIZE + result->type.size;
+    return true;
+}
 bool wic_convert_packet_to_buffer(uint8_t* result, WicPacket* packet)
 {
     if(!result)
@@ -64,6 +88,16 @@ bool wic_convert_packet_to_buffer(uint8_t* result, WicPacket* packet)
     memcpy(result, packet, WIC_PACKET_HEADER_SIZE + packet->type.size);
     return true;
 }
+bool wic_wait_socket(int socket, double timeout)
+{
+    struct pollfd fd = {socket, POLLIN, 0};
+    int milliseconds = timeout < 0 ? -1 : (int) (timeout * 1000 + 0.999);
+    int result;
+    do
+        result = poll(&fd, 1, milliseconds);
+    while(result < 0 && errno == EINTR);
+    return result > 0 && (fd.revents & POLLIN);
+}
 bool wic_is_reserved_packet_id(uint8_t packet_id)
 {
     return packet_id <= 15;
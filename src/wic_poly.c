@@ -28,8 +28,124 @@ struct WicGame
     double previous_time;
     double delta;
     FT_Library freetype_library;
+    enum WicPaceMode pace_mode;
+    double next_frame_time;
+    double sleep_overshoot;
+    unsigned* frame_histogram;
+    unsigned num_frames;
+    double min_frame_time;
+    double total_frame_time;
     
 };
+bool wic_render_is_recording();
+bool wic_render_add_mesh(unsigned buffer, unsigned num_vertices,
+                         WicTransform transform, WicColor color);
+void wic_render_submit();
+void wic_render_call(void (*function)(void*), void* data);
+bool wic_render_cull(WicBounds bounds);
+/* determines whether or not the corner at remaining[i] can be clipped */
+bool wic_is_ear(WicPair* vertices, unsigned* remaining, unsigned num_remaining,
+                unsigned i, double winding)
+{
+    WicPair a = vertices[remaining[(i + num_remaining - 1) % num_remaining]];
+    WicPair b = vertices[remaining[i]];
+    WicPair c = vertices[remaining[(i + 1) % num_remaining]];
+    if(((b.x - a.x) * (c.y - b.y) - (b.y - a.y) * (c.x - b.x)) * winding < 0)
+        return false;
+    for(unsigned j = 0; j < num_remaining; j++)
+    {
+        WicPair p = vertices[remaining[j]];
+        if((p.x == a.x && p.y == a.y) || (p.x == b.x && p.y == b.y) ||
+           (p.x == c.x && p.y == c.y))
+            continue;
+        if(((b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x)) *
+           winding >= 0 &&
+           ((c.x - b.x) * (p.y - b.y) - (c.y - b.y) * (p.x - b.x)) *
+           winding >= 0 &&
+           ((a.x - c.x) * (p.y - c.y) - (a.y - c.y) * (p.x - c.x)) *
+           winding >= 0)
+            return false;
+    }
+    return true;
+}
+/* fills triangles with an ear clipping triangulation of vertices */
+bool wic_triangulate(WicPair* vertices, unsigned num_vertices,
+                     WicPair* triangles)
+{
+    unsigned* remaining = malloc(sizeof(unsigned) * num_vertices);
+    if(!remaining)
+        return wic_throw_error(WIC_ERRNO_NO_HEAP);
+    double area = 0;
+    for(unsigned i = 0; i < num_vertices; i++)
+    {
+        WicPair a = vertices[i];
+        WicPair b = vertices[(i + 1) % num_vertices];
+        area += a.x * b.y - b.x * a.y;
+        remaining[i] = i;
+    }
+    double winding = area < 0 ? -1 : 1;
+    unsigned num_remaining = num_vertices;
+    unsigned num_triangles = 0;
+    unsigned i = 0;
+    unsigned misses = 0;
+    while(num_remaining > 3)
+    {
+        /* a self-intersecting polygon may run out of ears, so after a full
+         * pass without one the current corner is clipped anyway */
+        if(misses < num_remaining &&
+           !wic_is_ear(vertices, remaining, num_remaining, i, winding))
+        {
+            i = (i + 1) % num_remaining;
+            misses++;
+            continue;
+        }
+        triangles[num_triangles * 3] =
+            vertices[remaining[(i + num_remaining - 1) % num_remaining]];
+        triangles[num_triangles * 3 + 1] = vertices[remaining[i]];
+        triangles[num_triangles * 3 + 2] =
+            vertices[remaining[(i + 1) % num_remaining]];
+        num_triangles++;
+        memmove(&remaining[i], &remaining[i + 1],
+                sizeof(unsigned) * (num_remaining - i - 1));
+        num_remaining--;
+        i = i ? i - 1 : num_remaining - 1;
+        misses = 0;
+    }
+    for(unsigned j = 0; j < 3; j++)
+        triangles[num_triangles * 3 + j] = vertices[remaining[j]];
+    free(remaining);
+    return true;
+}
+/* uploads a WicPoly's triangles to a new GPU vertex buffer */
+void wic_poly_create_buffer(void* target)
+{
+    WicPoly* poly = target;
+    unsigned num_floats = (poly->num_vertices - 2) * 3 * 2;
+    GLfloat* positions = malloc(sizeof(GLfloat) * num_floats);
+    if(!positions)
+        return;
+    for(unsigned i = 0; i < num_floats / 2; i++)
+    {
+        positions[i * 2] = poly->triangles[i].x;
+        positions[i * 2 + 1] = poly->triangles[i].y;
+    }
+    glGenBuffers(1, &poly->buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, poly->buffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * num_floats, positions,
+                 GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    free(positions);
+    if(glGetError() == GL_OUT_OF_MEMORY)
+    {
+        glDeleteBuffers(1, &poly->buffer);
+        poly->buffer = 0;
+    }
+}
+/* deletes a WicPoly's GPU vertex buffer */
+void wic_poly_delete_buffer(void* target)
+{
+    glDeleteBuffers(1, &((WicPoly*) target)->buffer);
+}
 bool wic_init_poly(WicPoly* target, WicPair location, WicPair* vertices,
                       unsigned num_vertices, WicColor color)
 {
@@ -43,6 +159,18 @@ bool wic_init_poly(WicPoly* target, WicPair location, WicPair* vertices,
     if(!new_vertices)
         return wic_throw_error(WIC_ERRNO_NO_HEAP);
     memcpy(new_vertices, vertices, num_vertices * sizeof(WicPair));
+    WicPair* triangles = malloc(sizeof(WicPair) * (num_vertices - 2) * 3);
+    if(!triangles)
+    {
+        free(new_vertices);
+        return wic_throw_error(WIC_ERRNO_NO_HEAP);
+    }
+    if(!wic_triangulate(vertices, num_vertices, triangles))
+    {
+        free(new_vertices);
+        free(triangles);
+        return false;
+    }
     
     target->location = location;
     target->center = (WicPair) {0,0};
@@ -52,6 +180,20 @@ bool wic_init_poly(WicPoly* target, WicPair location, WicPair* vertices,
     target->draw_centered = false;
     target->vertices = new_vertices;
     target->num_vertices = num_vertices;
+    target->triangles = triangles;
+    target->buffer = 0;
+    target->bounds = (WicBounds) {vertices[0], vertices[0]};
+    for(unsigned i = 1; i < num_vertices; i++)
+    {
+        target->bounds.lower_left.x = fmin(target->bounds.lower_left.x,
+                                           vertices[i].x);
+        target->bounds.lower_left.y = fmin(target->bounds.lower_left.y,
+                                           vertices[i].y);
+        target->bounds.upper_right.x = fmax(target->bounds.upper_right.x,
+                                            vertices[i].x);
+        target->bounds.upper_right.y = fmax(target->bounds.upper_right.y,
+                                            vertices[i].y);
+    }
     return true;
 }
 WicPair wic_poly_get_geo_center(WicPoly* target)
@@ -74,27 +216,27 @@ bool wic_draw_poly(WicPoly* target, WicGame* game)
         return wic_throw_error(WIC_ERRNO_NULL_TARGET);
     if(!game)
         return wic_throw_error(WIC_ERRNO_NULL_GAME);
-    double cosine = cos(target->rotation);
-    double sine = sin(target->rotation);
-    glColor4ub(target->color.red, target->color.green, target->color.blue,
-               target->color.alpha);
-    glBegin(GL_POLYGON);
-    for(unsigned i = 0; i < target->num_vertices; i++)
+    if(wic_render_cull(wic_get_drawable_bounds(target->location,
+                                               target->center,
+                                               target->rotation, target->scale,
+                                               target->draw_centered,
+                                               target->bounds)))
+        return true;
+    if(!target->buffer)
     {
-        WicPair vertex = target->vertices[i];
-        vertex = wic_subtract_pairs(vertex, target->center);
-        vertex = wic_multiply_pairs(vertex, target->scale);
-        double x = vertex.x * cosine - vertex.y * sine;
-        double y = vertex.x * sine + vertex.y * cosine;
-        vertex.x = x;
-        vertex.y = y;
-        if(!target->draw_centered)
-            vertex = wic_add_pairs(vertex, target->center);
-        vertex = wic_convert_location(wic_add_pairs(vertex, target->location),
-                                      game->dimensions);
-        glVertex2d(vertex.x, vertex.y);
+        wic_render_call(wic_poly_create_buffer, target);
+        if(!target->buffer)
+            return wic_throw_error(WIC_ERRNO_NO_GPU_MEM);
     }
-    glEnd();
+    WicTransform transform = wic_get_transform(target->location,
+                                               target->center,
+                                               target->rotation, target->scale,
+                                               target->draw_centered);
+    if(!wic_render_add_mesh(target->buffer, (target->num_vertices - 2) * 3,
+                            transform, target->color))
+        return false;
+    if(!wic_render_is_recording())
+        wic_render_submit();
     return true;
 }
 bool wic_free_poly(WicPoly* target)
@@ -102,6 +244,9 @@ bool wic_free_poly(WicPoly* target)
     if(!target)
         return wic_throw_error(WIC_ERRNO_NULL_TARGET);
     free(target->vertices);
+    free(target->triangles);
+    if(target->buffer)
+        wic_render_call(wic_poly_delete_buffer, target);
     
     target->location = (WicPair) {0,0};
     target->center = (WicPair) {0,0};
@@ -111,5 +256,8 @@ bool wic_free_poly(WicPoly* target)
     target->draw_centered = false;
     target->vertices = 0;
     target->num_vertices = 0;
+    target->triangles = 0;
+    target->buffer = 0;
+    target->bounds = (WicBounds) {(WicPair) {0,0}, (WicPair) {0,0}};
     return true;
 }
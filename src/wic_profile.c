@@ -0,0 +1,173 @@
+/* ----------------------------------------------------------------------------
+ * wic - a simple 2D game engine for Mac OSX written in C
+ * Copyright (C) 2013-2017  Willis O'Leary
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * ----------------------------------------------------------------------------
+ * File:    wic_profile.c
+ * ----------------------------------------------------------------------------
+ */
+#include "wic_profile.h"
+#define WIC_PROFILE_CAPACITY 65536
+typedef struct WicProfileEvent
+{
+    const char* name;
+    uint64_t time;
+    double value;
+    char phase;
+} WicProfileEvent;
+typedef struct WicProfileBuffer
+{
+    WicProfileEvent* events;
+    uint64_t head;
+    uint64_t start;
+    unsigned thread;
+    struct WicProfileBuffer* next;
+} WicProfileBuffer;
+static __thread WicProfileBuffer* wic_profile_buffer = 0;
+static WicProfileBuffer* wic_profile_buffers = 0;
+static unsigned wic_num_profile_threads = 0;
+uint64_t wic_profile_get_time()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+}
+/* creates the calling thread's buffer and pushes it onto the buffer list */
+WicProfileBuffer* wic_profile_add_buffer()
+{
+    WicProfileBuffer* result = malloc(sizeof(WicProfileBuffer));
+    if(!result)
+        return 0;
+    result->events = malloc(WIC_PROFILE_CAPACITY * sizeof(WicProfileEvent));
+    if(!result->events)
+    {
+        free(result);
+        return 0;
+    }
+    result->head = 0;
+    result->start = 0;
+    result->thread = __atomic_fetch_add(&wic_num_profile_threads, 1,
+                                        __ATOMIC_RELAXED);
+    result->next = __atomic_load_n(&wic_profile_buffers, __ATOMIC_RELAXED);
+    while(!__atomic_compare_exchange_n(&wic_profile_buffers, &result->next,
+                                       result, true, __ATOMIC_RELEASE,
+                                       __ATOMIC_RELAXED));
+    wic_profile_buffer = result;
+    return result;
+}
+void wic_profile_record(const char* name, char phase, double value)
+{
+    WicProfileBuffer* buffer = wic_profile_buffer;
+    if(!buffer && !(buffer = wic_profile_add_buffer()))
+        return;
+    uint64_t head = buffer->head;
+    WicProfileEvent* event = &buffer->events[head % WIC_PROFILE_CAPACITY];
+    event->name = name;
+    event->time = wic_profile_get_time();
+    event->value = value;
+    event->phase = phase;
+    __atomic_store_n(&buffer->head, head + 1, __ATOMIC_RELEASE);
+}
+void wic_profile_begin(const char* name)
+{
+    wic_profile_record(name, 'B', 0.0);
+}
+void wic_profile_end(const char* name)
+{
+    wic_profile_record(name, 'E', 0.0);
+}
+void wic_profile_count(const char* name, double value)
+{
+    wic_profile_record(name, 'C', value);
+}
+void wic_profile_frame()
+{
+    wic_profile_record("frame", 'i', 0.0);
+}
+/* writes a JSON string, escaping the characters JSON requires */
+void wic_profile_write_string(FILE* file, const char* string)
+{
+    fputc('"', file);
+    for(; *string; string++)
+    {
+        if(*string == '"' || *string == '\\')
+            fputc('\\', file);
+        if((unsigned char) *string >= ' ')
+            fputc(*string, file);
+    }
+    fputc('"', file);
+}
+bool wic_profile_write_trace(const char* filepath)
+{
+    if(!filepath)
+        return wic_throw_error(WIC_ERRNO_NULL_FILEPATH);
+    WicProfileEvent* events = malloc(WIC_PROFILE_CAPACITY *
+                                     sizeof(WicProfileEvent));
+    if(!events)
+        return wic_throw_error(WIC_ERRNO_NO_HEAP);
+    FILE* file = fopen(filepath, "w");
+    if(!file)
+    {
+        free(events);
+        return wic_throw_error(WIC_ERRNO_WRITE_FILE_FAIL);
+    }
+    fputs("{\"traceEvents\":[", file);
+    bool first_event = true;
+    WicProfileBuffer* buffer = __atomic_load_n(&wic_profile_buffers,
+                                               __ATOMIC_ACQUIRE);
+    for(; buffer; buffer = buffer->next)
+    {
+        uint64_t head = __atomic_load_n(&buffer->head, __ATOMIC_ACQUIRE);
+        uint64_t start = __atomic_load_n(&buffer->start, __ATOMIC_ACQUIRE);
+        if(head - start > WIC_PROFILE_CAPACITY)
+            start = head - WIC_PROFILE_CAPACITY;
+        for(uint64_t i = start; i < head; i++)
+            events[i - start] = buffer->events[i % WIC_PROFILE_CAPACITY];
+        /* drop events the writer overwrote, or began to, during the copy */
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint64_t new_head = __atomic_load_n(&buffer->head, __ATOMIC_ACQUIRE);
+        for(uint64_t i = start; i < head; i++)
+        {
+            if(new_head - i >= WIC_PROFILE_CAPACITY)
+                continue;
+            WicProfileEvent* event = &events[i - start];
+            fputs(first_event ? "\n{\"name\":" : ",\n{\"name\":", file);
+            first_event = false;
+            wic_profile_write_string(file, event->name);
+            fprintf(file, ",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":0,\"tid\":%u",
+                    event->phase, event->time / 1000.0, buffer->thread);
+            if(event->phase == 'C')
+                fprintf(file, ",\"args\":{\"value\":%g}", event->value);
+            else if(event->phase == 'i')
+                fputs(",\"s\":\"p\"", file);
+            fputc('}', file);
+        }
+    }
+    fputs("\n]}\n", file);
+    free(events);
+    if(fclose(file))
+        return wic_throw_error(WIC_ERRNO_WRITE_FILE_FAIL);
+    return true;
+}
+void wic_profile_clear()
+{
+    WicProfileBuffer* buffer = __atomic_load_n(&wic_profile_buffers,
+                                               __ATOMIC_ACQUIRE);
+    for(; buffer; buffer = buffer->next)
+    {
+        uint64_t head = __atomic_load_n(&buffer->head, __ATOMIC_ACQUIRE);
+        __atomic_store_n(&buffer->start, head, __ATOMIC_RELEASE);
+    }
+}
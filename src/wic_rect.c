@@ -28,8 +28,48 @@ struct WicGame
     double previous_time;
     double delta;
     FT_Library freetype_library;
+    enum WicPaceMode pace_mode;
+    double next_frame_time;
+    double sleep_overshoot;
+    unsigned* frame_histogram;
+    unsigned num_frames;
+    double min_frame_time;
+    double total_frame_time;
     
 };
+typedef struct WicVertex
+{
+    GLfloat x;
+    GLfloat y;
+    GLfloat u;
+    GLfloat v;
+    WicColor color;
+} WicVertex;
+typedef struct WicInstance
+{
+    GLfloat x;
+    GLfloat y;
+    GLfloat center_x;
+    GLfloat center_y;
+    GLfloat width;
+    GLfloat height;
+    GLfloat scale_x;
+    GLfloat scale_y;
+    GLfloat rotation;
+    GLfloat u0;
+    GLfloat v0;
+    GLfloat u1;
+    GLfloat v1;
+    WicColor color;
+} WicInstance;
+bool wic_render_is_recording();
+bool wic_render_is_core();
+WicVertex* wic_render_add(unsigned texture, GLenum mode, unsigned num_vertices);
+WicInstance* wic_render_add_instances(unsigned texture, unsigned num_instances);
+void wic_render_submit();
+void wic_render_trim(unsigned count);
+bool wic_render_cull(WicBounds bounds);
+bool wic_render_is_offscreen(WicBounds bounds);
 static WicPair vertices[4] = {(WicPair) {0,0}};
 bool wic_init_rect(WicRect* target, WicPair location, WicPair dimensions,
                    WicColor color)
@@ -55,36 +95,133 @@ WicPair wic_rect_get_geo_center(WicRect* target)
     }
     return wic_divide_pairs(target->dimensions, (WicPair) {2,2});
 }
+/* computes screen bounds that contain a WicRect */
+WicBounds wic_rect_get_bounds(WicRect* target)
+{
+    return wic_get_drawable_bounds(target->location, target->center,
+                                   target->rotation, target->scale,
+                                   target->draw_centered,
+                                   (WicBounds) {(WicPair) {0,0},
+                                                target->dimensions});
+}
+/* fills the window coordinates of the corners of a WicRect */
+void wic_rect_get_quad(WicRect* target, WicPair* quad)
+{
+    vertices[1].x = target->dimensions.x;
+    vertices[2] = target->dimensions;
+    vertices[3].y = target->dimensions.y; 
+    WicTransform transform = wic_get_transform(target->location,
+                                               target->center,
+                                               target->rotation, target->scale,
+                                               target->draw_centered);
+    wic_transform_pairs(transform, vertices, quad, 4);
+}
 bool wic_draw_rect(WicRect* target, WicGame* game)
 {
     if(!target)
         return wic_throw_error(WIC_ERRNO_NULL_TARGET);
     if(!game)
         return wic_throw_error(WIC_ERRNO_NULL_GAME);
-    double cosine = cos(target->rotation);
-    double sine = sin(target->rotation);
-    glColor4ub(target->color.red, target->color.green, target->color.blue,
-               target->color.alpha);
-    vertices[1].x = target->dimensions.x;
-    vertices[2] = target->dimensions;
-    vertices[3].y = target->dimensions.y; 
-    glBegin(GL_QUADS);
+    if(wic_render_cull(wic_rect_get_bounds(target)))
+        return true;
+    WicVertex* packet_vertices = 0;
+    if(wic_render_is_recording() &&
+       !(packet_vertices = wic_render_add(0, GL_QUADS, 4)))
+        return false;
+    WicPair quad[4];
+    wic_rect_get_quad(target, quad);
+    if(!packet_vertices)
+    {
+        glColor4ub(target->color.red, target->color.green, target->color.blue,
+                   target->color.alpha);
+        glBegin(GL_QUADS);
+    }
     for(unsigned i = 0; i < 4; i++)
     {
-        WicPair vertex = vertices[i];
-        vertex = wic_subtract_pairs(vertex, target->center);
-        vertex = wic_multiply_pairs(vertex, target->scale);
-        double x = vertex.x * cosine - vertex.y * sine;
-        double y = vertex.x * sine + vertex.y * cosine;
-        vertex.x = x;
-        vertex.y = y;
-        if(!target->draw_centered)
-            vertex = wic_add_pairs(vertex, target->center);
-        vertex = wic_convert_location(wic_add_pairs(vertex, target->location),
-                                      game->dimensions);
-        glVertex2d(vertex.x, vertex.y);
+        if(packet_vertices)
+            packet_vertices[i] = (WicVertex) {quad[i].x, quad[i].y, 0, 0,
+                                              target->color};
+        else
+            glVertex2d(quad[i].x, quad[i].y);
     }
-    glEnd();
+    if(!packet_vertices)
+        glEnd();
     return true;
 }
-
+bool wic_draw_rects(WicRect* targets, unsigned num_targets, WicGame* game)
+{
+    if(!targets)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!game)
+        return wic_throw_error(WIC_ERRNO_NULL_GAME);
+    if(!num_targets)
+        return true;
+    WIC_PROFILE_BEGIN("wic_draw_rects");
+    unsigned num_visible = 0;
+    if(wic_render_is_core())
+    {
+        WicInstance* instances = wic_render_add_instances(0, num_targets);
+        for(unsigned i = 0; instances && i < num_targets; i++)
+        {
+            WicRect* target = &targets[i];
+            if(wic_render_cull(wic_rect_get_bounds(target)))
+                continue;
+            WicPair offset = target->location;
+            if(!target->draw_centered)
+                offset = wic_add_pairs(offset, target->center);
+            instances[num_visible++] = (WicInstance) {offset.x, offset.y,
+                                                      target->center.x,
+                                                      target->center.y,
+                                                      target->dimensions.x,
+                                                      target->dimensions.y,
+                                                      target->scale.x,
+                                                      target->scale.y,
+                                                      target->rotation,
+                                                      0, 0, 0, 0,
+                                                      target->color};
+        }
+        if(instances)
+            wic_render_trim(num_targets - num_visible);
+        WIC_PROFILE_END("wic_draw_rects");
+        return instances != 0;
+    }
+    /* without instancing the quads are expanded into one batched draw */
+    WicVertex* packet_vertices = wic_render_add(0, GL_QUADS, num_targets * 4);
+    for(unsigned i = 0; packet_vertices && i < num_targets; i++)
+    {
+        if(wic_render_cull(wic_rect_get_bounds(&targets[i])))
+            continue;
+        WicPair quad[4];
+        wic_rect_get_quad(&targets[i], quad);
+        for(unsigned j = 0; j < 4; j++)
+            packet_vertices[num_visible * 4 + j] = (WicVertex)
+                {quad[j].x, quad[j].y, 0, 0, targets[i].color};
+        num_visible++;
+    }
+    if(packet_vertices)
+    {
+        wic_render_trim((num_targets - num_visible) * 4);
+        if(!wic_render_is_recording())
+            wic_render_submit();
+    }
+    WIC_PROFILE_END("wic_draw_rects");
+    return packet_vertices != 0;
+}
+unsigned wic_cull_rects(WicRect* targets, unsigned num_targets, bool* visible,
+                        WicGame* game)
+{
+    if(!targets)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!visible)
+        return wic_throw_error(WIC_ERRNO_NULL_RESULT);
+    if(!game)
+        return wic_throw_error(WIC_ERRNO_NULL_GAME);
+    unsigned result = 0;
+    for(unsigned i = 0; i < num_targets; i++)
+    {
+        WicBounds bounds = wic_rect_get_bounds(&targets[i]);
+        visible[i] = !wic_render_is_offscreen(bounds);
+        result += visible[i];
+    }
+    return result;
+}
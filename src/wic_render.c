@@ -0,0 +1,912 @@
+/* ----------------------------------------------------------------------------
+ * wic - a simple 2D game engine for Mac OSX written in C
+ * Copyright (C) 2013-2017  Willis O'Leary
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * ----------------------------------------------------------------------------
+ * File:    wic_render.c
+ * ----------------------------------------------------------------------------
+ */
+#include <stddef.h>
+#include "wic_color.h"
+#include "wic_game.h"
+#include "wic_transform.h"
+typedef struct WicVertex
+{
+    GLfloat x;
+    GLfloat y;
+    GLfloat u;
+    GLfloat v;
+    WicColor color;
+} WicVertex;
+typedef struct WicInstance
+{
+    GLfloat x;             /**< the location, plus the center unless drawn
+                            *   centered */
+    GLfloat y;
+    GLfloat center_x;      /**< the center to scale and rotate around */
+    GLfloat center_y;
+    GLfloat width;         /**< the unscaled dimensions */
+    GLfloat height;
+    GLfloat scale_x;       /**< the scale */
+    GLfloat scale_y;
+    GLfloat rotation;      /**< the rotation in radians */
+    GLfloat u0;            /**< the texture coordinates of the lower left */
+    GLfloat v0;
+    GLfloat u1;            /**< the texture coordinates of the upper right */
+    GLfloat v1;
+    WicColor color;        /**< the color multiplier */
+} WicInstance;
+typedef struct WicMesh
+{
+    unsigned buffer;        /**< the GPU vertex buffer of triangle positions */
+    WicTransform transform; /**< the transform to draw with */
+    WicColor color;         /**< the color */
+} WicMesh;
+typedef struct WicRenderCommand
+{
+    unsigned texture;      /**< the texture to draw with, 0 for none */
+    GLenum mode;           /**< the primitive mode, WIC_INSTANCES, WIC_MESH,
+                            *   or WIC_VIEW */
+    unsigned first;        /**< the index of the first vertex or instance, or
+                            *   the index of the mesh or view */
+    unsigned count;        /**< the number of vertices or instances */
+} WicRenderCommand;
+typedef struct WicFramePacket
+{
+    WicTransform view;          /**< the view the packet starts with */
+    WicTransform* views;        /**< the views set during the packet */
+    unsigned num_views;         /**< the number of views */
+    unsigned max_views;         /**< the capacity of views */
+    WicVertex* vertices;        /**< the vertices of every command */
+    unsigned num_vertices;      /**< the number of vertices */
+    unsigned max_vertices;      /**< the capacity of vertices */
+    WicInstance* instances;     /**< the quad instances of every command */
+    unsigned num_instances;     /**< the number of instances */
+    unsigned max_instances;     /**< the capacity of instances */
+    WicMesh* meshes;            /**< the meshes of every command */
+    unsigned num_meshes;        /**< the number of meshes */
+    unsigned max_meshes;        /**< the capacity of meshes */
+    WicRenderCommand* commands; /**< the draw commands, in order */
+    unsigned num_commands;      /**< the number of commands */
+    unsigned max_commands;      /**< the capacity of commands */
+} WicFramePacket;
+/* marks commands that draw instances of a unit quad (only in core mode) */
+#define WIC_INSTANCES 0xFFFF
+/* marks commands that draw the triangles of a mesh's own buffer */
+#define WIC_MESH 0xFFFE
+/* marks commands that change the view of the following commands */
+#define WIC_VIEW 0xFFFD
+static pthread_mutex_t wic_render_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wic_render_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t wic_render_thread;
+static bool wic_render_threaded = false;
+static bool wic_render_stopping = false;
+static GLFWwindow* wic_render_window = 0;
+static WicFramePacket wic_packets[2];
+static unsigned wic_write_packet = 0;
+static bool wic_packet_ready = false;
+static void (*wic_render_function)(void*) = 0;
+static void* wic_render_data = 0;
+static bool wic_render_core = false;
+static WicPair wic_render_dimensions = {0,0};
+static GLuint wic_program = 0;
+static GLint wic_projection_location = -1;
+static GLuint wic_vertex_array = 0;
+static GLuint wic_vertex_buffer = 0;
+static GLuint wic_index_buffer = 0;
+static unsigned wic_max_quads = 0;
+static GLuint wic_white_texture = 0;
+static GLuint wic_instance_program = 0;
+static GLint wic_instance_projection_location = -1;
+static GLuint wic_instance_array = 0;
+static GLuint wic_instance_buffer = 0;
+static GLuint wic_unit_quad_buffer = 0;
+static GLuint wic_mesh_array = 0;
+static WicTransform wic_render_view = {1, 0, 0, 1, 0, 0};
+static unsigned wic_num_culled = 0;
+static unsigned wic_frame_culled = 0;
+static const char* WIC_VERTEX_SHADER =
+    "#version 330 core\n"
+    "layout(location = 0) in vec2 position;\n"
+    "layout(location = 1) in vec2 tex_coord;\n"
+    "layout(location = 2) in vec4 color;\n"
+    "uniform mat4 projection;\n"
+    "out vec2 fragment_tex_coord;\n"
+    "out vec4 fragment_color;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_Position = projection * vec4(position, 0.0, 1.0);\n"
+    "    fragment_tex_coord = tex_coord;\n"
+    "    fragment_color = color;\n"
+    "}\n";
+static const char* WIC_FRAGMENT_SHADER =
+    "#version 330 core\n"
+    "in vec2 fragment_tex_coord;\n"
+    "in vec4 fragment_color;\n"
+    "uniform sampler2D image;\n"
+    "out vec4 result;\n"
+    "void main()\n"
+    "{\n"
+    "    result = fragment_color * texture(image, fragment_tex_coord);\n"
+    "}\n";
+static const char* WIC_INSTANCE_SHADER =
+    "#version 330 core\n"
+    "layout(location = 0) in vec2 corner;\n"
+    "layout(location = 3) in vec4 placement;\n"
+    "layout(location = 4) in vec4 size;\n"
+    "layout(location = 5) in float rotation;\n"
+    "layout(location = 6) in vec4 tex_bounds;\n"
+    "layout(location = 7) in vec4 color;\n"
+    "uniform mat4 projection;\n"
+    "out vec2 fragment_tex_coord;\n"
+    "out vec4 fragment_color;\n"
+    "void main()\n"
+    "{\n"
+    "    vec2 local = (corner * size.xy - placement.zw) * size.zw;\n"
+    "    float cosine = cos(rotation);\n"
+    "    float sine = sin(rotation);\n"
+    "    vec2 position = vec2(local.x * cosine - local.y * sine,\n"
+    "                         local.x * sine + local.y * cosine);\n"
+    "    position += placement.xy;\n"
+    "    gl_Position = projection * vec4(position, 0.0, 1.0);\n"
+    "    fragment_tex_coord = mix(tex_bounds.xy, tex_bounds.zw, corner);\n"
+    "    fragment_color = color;\n"
+    "}\n";
+/* fills the column-major orthographic projection of the window */
+void wic_get_projection(GLfloat* matrix)
+{
+    memset(matrix, 0, 16 * sizeof(GLfloat));
+    matrix[0] = 2 / wic_render_dimensions.x;
+    matrix[5] = 2 / wic_render_dimensions.y;
+    matrix[10] = -1;
+    matrix[12] = -1;
+    matrix[13] = -1;
+    matrix[15] = 1;
+}
+/* fills the column-major matrix of a transform */
+void wic_get_model(WicTransform transform, GLfloat* matrix)
+{
+    memset(matrix, 0, 16 * sizeof(GLfloat));
+    matrix[0] = transform.a;
+    matrix[1] = transform.b;
+    matrix[4] = transform.c;
+    matrix[5] = transform.d;
+    matrix[10] = 1;
+    matrix[12] = transform.tx;
+    matrix[13] = transform.ty;
+    matrix[15] = 1;
+}
+/* multiplies the column-major matrices a and b */
+void wic_multiply_matrices(GLfloat* a, GLfloat* b, GLfloat* result)
+{
+    for(unsigned column = 0; column < 4; column++)
+    {
+        for(unsigned row = 0; row < 4; row++)
+        {
+            result[column * 4 + row] = 0;
+            for(unsigned i = 0; i < 4; i++)
+                result[column * 4 + row] += a[i * 4 + row] *
+                                            b[column * 4 + i];
+        }
+    }
+}
+/* fills the column-major projection of the window combined with a view */
+void wic_get_view_projection(WicTransform view, GLfloat* matrix)
+{
+    GLfloat projection[16];
+    GLfloat model[16];
+    wic_get_projection(projection);
+    wic_get_model(view, model);
+    wic_multiply_matrices(projection, model, matrix);
+}
+/* compiles a shader, returning 0 on failure */
+GLuint wic_compile_shader(GLenum type, const char* source)
+{
+    GLuint result = glCreateShader(type);
+    glShaderSource(result, 1, &source, 0);
+    glCompileShader(result);
+    GLint success = GL_FALSE;
+    glGetShaderiv(result, GL_COMPILE_STATUS, &success);
+    if(!success)
+    {
+        glDeleteShader(result);
+        return 0;
+    }
+    return result;
+}
+/* links a vertex shader with the fragment shader, returning 0 on failure */
+GLuint wic_link_program(const char* vertex_source)
+{
+    GLuint vertex = wic_compile_shader(GL_VERTEX_SHADER, vertex_source);
+    GLuint fragment = wic_compile_shader(GL_FRAGMENT_SHADER,
+                                         WIC_FRAGMENT_SHADER);
+    GLuint result = 0;
+    if(vertex && fragment)
+    {
+        result = glCreateProgram();
+        glAttachShader(result, vertex);
+        glAttachShader(result, fragment);
+        glLinkProgram(result);
+        GLint success = GL_FALSE;
+        glGetProgramiv(result, GL_LINK_STATUS, &success);
+        if(!success)
+        {
+            glDeleteProgram(result);
+            result = 0;
+        }
+    }
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+    return result;
+}
+/* creates the program, buffers, and vertex array of the core backend */
+bool wic_init_core()
+{
+    wic_program = wic_link_program(WIC_VERTEX_SHADER);
+    wic_instance_program = wic_link_program(WIC_INSTANCE_SHADER);
+    if(!wic_program || !wic_instance_program)
+    {
+        glDeleteProgram(wic_program);
+        glDeleteProgram(wic_instance_program);
+        return wic_throw_error(WIC_ERRNO_SHADER_FAIL);
+    }
+    wic_projection_location = glGetUniformLocation(wic_program, "projection");
+    glUseProgram(wic_program);
+    glUniform1i(glGetUniformLocation(wic_program, "image"), 0);
+    glGenVertexArrays(1, &wic_vertex_array);
+    glBindVertexArray(wic_vertex_array);
+    glGenBuffers(1, &wic_vertex_buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, wic_vertex_buffer);
+    glGenBuffers(1, &wic_index_buffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, wic_index_buffer);
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(WicVertex),
+                          (void*) offsetof(WicVertex, x));
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(WicVertex),
+                          (void*) offsetof(WicVertex, u));
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(WicVertex),
+                          (void*) offsetof(WicVertex, color));
+    glBindVertexArray(0);
+    wic_instance_projection_location = glGetUniformLocation(
+        wic_instance_program, "projection");
+    glUseProgram(wic_instance_program);
+    glUniform1i(glGetUniformLocation(wic_instance_program, "image"), 0);
+    GLfloat corners[] = {0, 0, 1, 0, 1, 1, 0, 1};
+    glGenVertexArrays(1, &wic_instance_array);
+    glBindVertexArray(wic_instance_array);
+    glGenBuffers(1, &wic_unit_quad_buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, wic_unit_quad_buffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    glGenBuffers(1, &wic_instance_buffer);
+    for(GLuint i = 3; i <= 7; i++)
+    {
+        glEnableVertexAttribArray(i);
+        glVertexAttribDivisor(i, 1);
+    }
+    glBindVertexArray(0);
+    glGenVertexArrays(1, &wic_mesh_array);
+    glBindVertexArray(wic_mesh_array);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+    /* untextured draws sample an opaque white texel */
+    unsigned char white[4] = {255, 255, 255, 255};
+    glGenTextures(1, &wic_white_texture);
+    glBindTexture(GL_TEXTURE_2D, wic_white_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, white);
+    return true;
+}
+/* grows the quad index buffer to hold at least num_quads quads */
+bool wic_reserve_quads(unsigned num_quads)
+{
+    if(num_quads <= wic_max_quads)
+        return true;
+    unsigned max_quads = wic_max_quads ? wic_max_quads : 1024;
+    while(max_quads < num_quads)
+        max_quads *= 2;
+    GLuint* indices = malloc(max_quads * 6 * sizeof(GLuint));
+    if(!indices)
+        return wic_throw_error(WIC_ERRNO_NO_HEAP);
+    /* each quad is split into two triangles sharing its diagonal */
+    for(unsigned i = 0; i < max_quads; i++)
+    {
+        indices[i*6] = i*4;
+        indices[i*6+1] = i*4 + 1;
+        indices[i*6+2] = i*4 + 2;
+        indices[i*6+3] = i*4;
+        indices[i*6+4] = i*4 + 2;
+        indices[i*6+5] = i*4 + 3;
+    }
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, max_quads * 6 * sizeof(GLuint),
+                 indices, GL_STATIC_DRAW);
+    free(indices);
+    wic_max_quads = max_quads;
+    return true;
+}
+/* draws instances [first, first + count) of the instance buffer */
+void wic_draw_instances(unsigned first, unsigned count)
+{
+    /* GL 3.3 has no base instance, so the attributes are offset instead */
+    char* base = (char*) (first * sizeof(WicInstance));
+    glBindBuffer(GL_ARRAY_BUFFER, wic_instance_buffer);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(WicInstance),
+                          base + offsetof(WicInstance, x));
+    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(WicInstance),
+                          base + offsetof(WicInstance, width));
+    glVertexAttribPointer(5, 1, GL_FLOAT, GL_FALSE, sizeof(WicInstance),
+                          base + offsetof(WicInstance, rotation));
+    glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(WicInstance),
+                          base + offsetof(WicInstance, u0));
+    glVertexAttribPointer(7, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(WicInstance),
+                          base + offsetof(WicInstance, color));
+    glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, count);
+}
+/* draws the triangles of a mesh with the shader program */
+void wic_draw_mesh_core(WicMesh* mesh, unsigned count, GLfloat* projection)
+{
+    GLfloat model[16];
+    GLfloat matrix[16];
+    wic_get_model(mesh->transform, model);
+    wic_multiply_matrices(projection, model, matrix);
+    glUniformMatrix4fv(wic_projection_location, 1, GL_FALSE, matrix);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh->buffer);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    glVertexAttrib2f(1, 0, 0);
+    glVertexAttrib4Nub(2, mesh->color.red, mesh->color.green,
+                       mesh->color.blue, mesh->color.alpha);
+    glDrawArrays(GL_TRIANGLES, 0, count);
+}
+/* draws the triangles of a mesh with client state */
+void wic_draw_mesh_legacy(WicMesh* mesh, unsigned count)
+{
+    GLfloat model[16];
+    wic_get_model(mesh->transform, model);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glColor4ub(mesh->color.red, mesh->color.green, mesh->color.blue,
+               mesh->color.alpha);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh->buffer);
+    glVertexPointer(2, GL_FLOAT, 0, 0);
+    glPushMatrix();
+    glMultMatrixf(model);
+    glDrawArrays(GL_TRIANGLES, 0, count);
+    glPopMatrix();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+}
+/* draws a frame packet with the shader programs */
+void wic_draw_packet_core(WicFramePacket* packet)
+{
+    GLfloat projection[16];
+    wic_get_view_projection(packet->view, projection);
+    glUseProgram(wic_program);
+    glUniformMatrix4fv(wic_projection_location, 1, GL_FALSE, projection);
+    glBindVertexArray(wic_vertex_array);
+    glBindBuffer(GL_ARRAY_BUFFER, wic_vertex_buffer);
+    glBufferData(GL_ARRAY_BUFFER, packet->num_vertices * sizeof(WicVertex),
+                 packet->vertices, GL_STREAM_DRAW);
+    if(packet->num_instances)
+    {
+        glUseProgram(wic_instance_program);
+        glUniformMatrix4fv(wic_instance_projection_location, 1, GL_FALSE,
+                           projection);
+        glUseProgram(wic_program);
+        glBindBuffer(GL_ARRAY_BUFFER, wic_instance_buffer);
+        glBufferData(GL_ARRAY_BUFFER,
+                     packet->num_instances * sizeof(WicInstance),
+                     packet->instances, GL_STREAM_DRAW);
+    }
+    glActiveTexture(GL_TEXTURE0);
+    GLuint array = wic_vertex_array;
+    for(unsigned i = 0; i < packet->num_commands; i++)
+    {
+        WicRenderCommand* command = &packet->commands[i];
+        if(command->mode == WIC_VIEW)
+        {
+            wic_get_view_projection(packet->views[command->first],
+                                    projection);
+            glUseProgram(wic_instance_program);
+            glUniformMatrix4fv(wic_instance_projection_location, 1, GL_FALSE,
+                               projection);
+            glUseProgram(wic_program);
+            glUniformMatrix4fv(wic_projection_location, 1, GL_FALSE,
+                               projection);
+            if(array == wic_instance_array)
+                glUseProgram(wic_instance_program);
+            continue;
+        }
+        glBindTexture(GL_TEXTURE_2D, command->texture ? command->texture :
+                                                        wic_white_texture);
+        GLuint next_array = wic_vertex_array;
+        if(command->mode == WIC_INSTANCES)
+            next_array = wic_instance_array;
+        else if(command->mode == WIC_MESH)
+            next_array = wic_mesh_array;
+        if(next_array != array)
+        {
+            if(array == wic_mesh_array)
+                glUniformMatrix4fv(wic_projection_location, 1, GL_FALSE,
+                                   projection);
+            glUseProgram(next_array == wic_instance_array ?
+                         wic_instance_program : wic_program);
+            glBindVertexArray(next_array);
+            array = next_array;
+        }
+        if(command->mode == WIC_INSTANCES)
+        {
+            wic_draw_instances(command->first, command->count);
+            continue;
+        }
+        if(command->mode == WIC_MESH)
+        {
+            wic_draw_mesh_core(&packet->meshes[command->first],
+                               command->count, projection);
+            continue;
+        }
+        if(command->mode == GL_QUADS)
+        {
+            if(!wic_reserve_quads(command->count / 4))
+                continue;
+            glDrawElementsBaseVertex(GL_TRIANGLES, command->count / 4 * 6,
+                                     GL_UNSIGNED_INT, 0, command->first);
+        }
+        else if(command->mode == GL_POLYGON)
+            glDrawArrays(GL_TRIANGLE_FAN, command->first, command->count);
+        else
+            glDrawArrays(command->mode, command->first, command->count);
+    }
+    glBindVertexArray(0);
+}
+/* draws a frame packet with client arrays */
+void wic_draw_packet(WicFramePacket* packet)
+{
+    if(!packet->num_commands)
+        return;
+    if(wic_render_core)
+    {
+        wic_draw_packet_core(packet);
+        return;
+    }
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(WicVertex), &packet->vertices[0].x);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(WicVertex), &packet->vertices[0].u);
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(WicVertex),
+                   &packet->vertices[0].color);
+    GLfloat view[16];
+    wic_get_model(packet->view, view);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadMatrixf(view);
+    for(unsigned i = 0; i < packet->num_commands; i++)
+    {
+        WicRenderCommand* command = &packet->commands[i];
+        if(command->mode == WIC_VIEW)
+        {
+            wic_get_model(packet->views[command->first], view);
+            glLoadMatrixf(view);
+            continue;
+        }
+        if(command->texture)
+        {
+            glEnable(GL_TEXTURE_2D);
+            glBindTexture(GL_TEXTURE_2D, command->texture);
+        }
+        else
+            glDisable(GL_TEXTURE_2D);
+        if(command->mode == WIC_MESH)
+        {
+            wic_draw_mesh_legacy(&packet->meshes[command->first],
+                                 command->count);
+            glVertexPointer(2, GL_FLOAT, sizeof(WicVertex),
+                            &packet->vertices[0].x);
+            continue;
+        }
+        glDrawArrays(command->mode, command->first, command->count);
+    }
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisable(GL_TEXTURE_2D);
+}
+/* clears the window and resets the projection for the next frame */
+void wic_render_begin_frame()
+{
+    glClearColor(0.0,0.0,0.0,1.0);
+    glClear(GL_COLOR_BUFFER_BIT);
+    if(wic_render_core)
+        return;
+    GLfloat projection[16];
+    wic_get_projection(projection);
+    glMatrixMode(GL_PROJECTION);
+    glLoadMatrixf(projection);
+    glMatrixMode(GL_MODELVIEW);
+}
+/* owns the GL context, running calls and drawing submitted packets */
+void* wic_run_renderer(void* unused)
+{
+    (void) unused;
+    glfwMakeContextCurrent(wic_render_window);
+    pthread_mutex_lock(&wic_render_mutex);
+    while(true)
+    {
+        while(!wic_render_function && !wic_packet_ready &&
+              !wic_render_stopping)
+            pthread_cond_wait(&wic_render_cond, &wic_render_mutex);
+        /* a packet is always submitted before a pending call was made */
+        if(wic_packet_ready)
+        {
+            WicFramePacket* packet = &wic_packets[!wic_write_packet];
+            pthread_mutex_unlock(&wic_render_mutex);
+            WIC_PROFILE_BEGIN("render");
+            wic_draw_packet(packet);
+            WIC_PROFILE_END("render");
+            WIC_PROFILE_BEGIN("swap");
+            glfwSwapBuffers(wic_render_window);
+            glFlush();
+            WIC_PROFILE_END("swap");
+            wic_render_begin_frame();
+            pthread_mutex_lock(&wic_render_mutex);
+            wic_packet_ready = false;
+            pthread_cond_broadcast(&wic_render_cond);
+        }
+        else if(wic_render_function)
+        {
+            pthread_mutex_unlock(&wic_render_mutex);
+            wic_render_function(wic_render_data);
+            pthread_mutex_lock(&wic_render_mutex);
+            wic_render_function = 0;
+            pthread_cond_broadcast(&wic_render_cond);
+        }
+        else
+            break;
+    }
+    pthread_mutex_unlock(&wic_render_mutex);
+    glfwMakeContextCurrent(0);
+    return 0;
+}
+bool wic_start_render_thread(GLFWwindow* window)
+{
+    if(wic_render_threaded)
+        return true;
+    wic_render_window = window;
+    wic_render_stopping = false;
+    glfwMakeContextCurrent(0);
+    if(pthread_create(&wic_render_thread, 0, wic_run_renderer, 0))
+    {
+        glfwMakeContextCurrent(window);
+        return wic_throw_error(WIC_ERRNO_THREAD_FAIL);
+    }
+    wic_render_threaded = true;
+    return true;
+}
+void wic_stop_render_thread()
+{
+    if(!wic_render_threaded)
+        return;
+    pthread_mutex_lock(&wic_render_mutex);
+    wic_render_stopping = true;
+    pthread_cond_broadcast(&wic_render_cond);
+    pthread_mutex_unlock(&wic_render_mutex);
+    pthread_join(wic_render_thread, 0);
+    wic_render_threaded = false;
+    wic_packet_ready = false;
+    glfwMakeContextCurrent(wic_render_window);
+}
+bool wic_init_renderer(enum WicBackend backend, WicPair dimensions)
+{
+    wic_render_core = backend == WIC_BACKEND_CORE;
+    wic_render_dimensions = dimensions;
+    wic_render_view = (WicTransform) {1, 0, 0, 1, 0, 0};
+    wic_packets[0].view = wic_render_view;
+    wic_packets[1].view = wic_render_view;
+    if(wic_render_core && !wic_init_core())
+    {
+        wic_render_core = false;
+        return false;
+    }
+    wic_render_begin_frame();
+    return true;
+}
+void wic_free_renderer()
+{
+    wic_stop_render_thread();
+    if(wic_render_core)
+    {
+        glDeleteProgram(wic_program);
+        glDeleteVertexArrays(1, &wic_vertex_array);
+        glDeleteBuffers(1, &wic_vertex_buffer);
+        glDeleteBuffers(1, &wic_index_buffer);
+        glDeleteTextures(1, &wic_white_texture);
+        glDeleteProgram(wic_instance_program);
+        glDeleteVertexArrays(1, &wic_instance_array);
+        glDeleteBuffers(1, &wic_instance_buffer);
+        glDeleteBuffers(1, &wic_unit_quad_buffer);
+        glDeleteVertexArrays(1, &wic_mesh_array);
+        wic_program = 0;
+        wic_vertex_array = 0;
+        wic_vertex_buffer = 0;
+        wic_index_buffer = 0;
+        wic_white_texture = 0;
+        wic_instance_program = 0;
+        wic_instance_array = 0;
+        wic_instance_buffer = 0;
+        wic_unit_quad_buffer = 0;
+        wic_mesh_array = 0;
+        wic_max_quads = 0;
+    }
+    for(unsigned i = 0; i < 2; i++)
+    {
+        free(wic_packets[i].vertices);
+        free(wic_packets[i].instances);
+        free(wic_packets[i].meshes);
+        free(wic_packets[i].views);
+        free(wic_packets[i].commands);
+        wic_packets[i] = (WicFramePacket) {0};
+    }
+    wic_render_core = false;
+}
+bool wic_render_is_threaded()
+{
+    return wic_render_threaded;
+}
+bool wic_render_is_core()
+{
+    return wic_render_core;
+}
+/* determines whether draws are recorded into a packet rather than issued */
+bool wic_render_is_recording()
+{
+    return wic_render_threaded || wic_render_core;
+}
+/* runs a function that makes GL calls on the thread that owns the context */
+void wic_render_call(void (*function)(void*), void* data)
+{
+    if(!wic_render_threaded ||
+       pthread_equal(pthread_self(), wic_render_thread))
+    {
+        function(data);
+        return;
+    }
+    pthread_mutex_lock(&wic_render_mutex);
+    while(wic_render_function)
+        pthread_cond_wait(&wic_render_cond, &wic_render_mutex);
+    wic_render_function = function;
+    wic_render_data = data;
+    pthread_cond_broadcast(&wic_render_cond);
+    while(wic_render_function)
+        pthread_cond_wait(&wic_render_cond, &wic_render_mutex);
+    pthread_mutex_unlock(&wic_render_mutex);
+}
+/* determines whether or not bounds lie entirely outside the window once the
+ * view is applied */
+bool wic_render_is_offscreen(WicBounds bounds)
+{
+    WicTransform view = wic_render_view;
+    double center_x = (bounds.lower_left.x + bounds.upper_right.x) / 2;
+    double center_y = (bounds.lower_left.y + bounds.upper_right.y) / 2;
+    double half_x = (bounds.upper_right.x - bounds.lower_left.x) / 2;
+    double half_y = (bounds.upper_right.y - bounds.lower_left.y) / 2;
+    double x = view.a * center_x + view.c * center_y + view.tx;
+    double y = view.b * center_x + view.d * center_y + view.ty;
+    double reach_x = fabs(view.a) * half_x + fabs(view.c) * half_y;
+    double reach_y = fabs(view.b) * half_x + fabs(view.d) * half_y;
+    return x + reach_x <= 0 || y + reach_y <= 0 ||
+           x - reach_x >= wic_render_dimensions.x ||
+           y - reach_y >= wic_render_dimensions.y;
+}
+/* determines whether or not a draw should be skipped, counting it if so */
+bool wic_render_cull(WicBounds bounds)
+{
+    if(!wic_render_is_offscreen(bounds))
+        return false;
+    wic_num_culled++;
+    return true;
+}
+/* finishes counting the draws culled this frame */
+void wic_render_end_frame()
+{
+    wic_frame_culled = wic_num_culled;
+    wic_num_culled = 0;
+}
+unsigned wic_render_get_num_culled()
+{
+    return wic_frame_culled;
+}
+/* appends a command, merging it into the last one where possible */
+bool wic_render_add_command(WicFramePacket* packet, unsigned texture,
+                            GLenum mode, unsigned first, unsigned count)
+{
+    WicRenderCommand* last = packet->num_commands ?
+                             &packet->commands[packet->num_commands - 1] : 0;
+    if(last && last->texture == texture && last->mode == mode &&
+       mode != GL_POLYGON && mode != WIC_MESH)
+        last->count += count;
+    else
+    {
+        if(packet->num_commands == packet->max_commands)
+        {
+            unsigned max_commands = packet->max_commands ?
+                                    packet->max_commands * 2 : 256;
+            WicRenderCommand* commands = realloc(packet->commands,
+                                                 max_commands *
+                                                 sizeof(WicRenderCommand));
+            if(!commands)
+                return wic_throw_error(WIC_ERRNO_NO_HEAP);
+            packet->commands = commands;
+            packet->max_commands = max_commands;
+        }
+        packet->commands[packet->num_commands++] = (WicRenderCommand)
+            {texture, mode, first, count};
+    }
+    return true;
+}
+/* reserves vertices for a draw command in the packet being recorded */
+WicVertex* wic_render_add(unsigned texture, GLenum mode, unsigned num_vertices)
+{
+    WicFramePacket* packet = &wic_packets[wic_write_packet];
+    if(packet->num_vertices + num_vertices > packet->max_vertices)
+    {
+        unsigned max_vertices = packet->max_vertices ?
+                                packet->max_vertices : 1024;
+        while(packet->num_vertices + num_vertices > max_vertices)
+            max_vertices *= 2;
+        WicVertex* vertices = realloc(packet->vertices,
+                                      max_vertices * sizeof(WicVertex));
+        if(!vertices)
+            return (void*) wic_throw_error(WIC_ERRNO_NO_HEAP);
+        packet->vertices = vertices;
+        packet->max_vertices = max_vertices;
+    }
+    if(!wic_render_add_command(packet, texture, mode, packet->num_vertices,
+                               num_vertices))
+        return 0;
+    WicVertex* result = &packet->vertices[packet->num_vertices];
+    packet->num_vertices += num_vertices;
+    return result;
+}
+/* records num_instances quad instances to be filled in by the caller */
+WicInstance* wic_render_add_instances(unsigned texture, unsigned num_instances)
+{
+    WicFramePacket* packet = &wic_packets[wic_write_packet];
+    if(packet->num_instances + num_instances > packet->max_instances)
+    {
+        unsigned max_instances = packet->max_instances ?
+                                 packet->max_instances : 1024;
+        while(packet->num_instances + num_instances > max_instances)
+            max_instances *= 2;
+        WicInstance* instances = realloc(packet->instances,
+                                         max_instances * sizeof(WicInstance));
+        if(!instances)
+            return (void*) wic_throw_error(WIC_ERRNO_NO_HEAP);
+        packet->instances = instances;
+        packet->max_instances = max_instances;
+    }
+    if(!wic_render_add_command(packet, texture, WIC_INSTANCES,
+                               packet->num_instances, num_instances))
+        return 0;
+    WicInstance* result = &packet->instances[packet->num_instances];
+    packet->num_instances += num_instances;
+    return result;
+}
+/* sets the view of the following draws, in this and later packets */
+bool wic_render_set_view(WicTransform view)
+{
+    WicFramePacket* packet = &wic_packets[wic_write_packet];
+    wic_render_view = view;
+    if(!wic_render_is_recording())
+    {
+        GLfloat matrix[16];
+        wic_get_model(view, matrix);
+        glMatrixMode(GL_MODELVIEW);
+        glLoadMatrixf(matrix);
+    }
+    if(!packet->num_commands)
+    {
+        packet->view = view;
+        return true;
+    }
+    WicRenderCommand* last = &packet->commands[packet->num_commands - 1];
+    if(last->mode == WIC_VIEW)
+    {
+        packet->views[last->first] = view;
+        return true;
+    }
+    if(packet->num_views == packet->max_views)
+    {
+        unsigned max_views = packet->max_views ? packet->max_views * 2 : 16;
+        WicTransform* views = realloc(packet->views,
+                                      max_views * sizeof(WicTransform));
+        if(!views)
+            return wic_throw_error(WIC_ERRNO_NO_HEAP);
+        packet->views = views;
+        packet->max_views = max_views;
+    }
+    if(!wic_render_add_command(packet, 0, WIC_VIEW, packet->num_views, 0))
+        return false;
+    packet->views[packet->num_views++] = view;
+    return true;
+}
+/* returns the last count vertices or instances reserved by the last call to
+ * wic_render_add or wic_render_add_instances */
+void wic_render_trim(unsigned count)
+{
+    WicFramePacket* packet = &wic_packets[wic_write_packet];
+    if(!count)
+        return;
+    WicRenderCommand* last = &packet->commands[packet->num_commands - 1];
+    if(last->mode == WIC_INSTANCES)
+        packet->num_instances -= count;
+    else
+        packet->num_vertices -= count;
+    last->count -= count;
+    if(!last->count)
+        packet->num_commands--;
+}
+/* records the triangles of a GPU vertex buffer, drawn with a transform */
+bool wic_render_add_mesh(unsigned buffer, unsigned num_vertices,
+                         WicTransform transform, WicColor color)
+{
+    WicFramePacket* packet = &wic_packets[wic_write_packet];
+    if(packet->num_meshes == packet->max_meshes)
+    {
+        unsigned max_meshes = packet->max_meshes ?
+                              packet->max_meshes * 2 : 64;
+        WicMesh* meshes = realloc(packet->meshes, max_meshes * sizeof(WicMesh));
+        if(!meshes)
+            return wic_throw_error(WIC_ERRNO_NO_HEAP);
+        packet->meshes = meshes;
+        packet->max_meshes = max_meshes;
+    }
+    if(!wic_render_add_command(packet, 0, WIC_MESH, packet->num_meshes,
+                               num_vertices))
+        return false;
+    packet->meshes[packet->num_meshes++] = (WicMesh) {buffer, transform, color};
+    return true;
+}
+/* hands the recorded packet to the render thread (or draws it on this thread
+ * when not threaded) and starts a new one */
+void wic_render_submit()
+{
+    if(!wic_render_threaded)
+    {
+        WIC_PROFILE_BEGIN("render");
+        wic_draw_packet(&wic_packets[wic_write_packet]);
+        WIC_PROFILE_END("render");
+    }
+    else
+    {
+        pthread_mutex_lock(&wic_render_mutex);
+        while(wic_packet_ready)
+            pthread_cond_wait(&wic_render_cond, &wic_render_mutex);
+        wic_write_packet = !wic_write_packet;
+        wic_packet_ready = true;
+        pthread_cond_broadcast(&wic_render_cond);
+        pthread_mutex_unlock(&wic_render_mutex);
+    }
+    wic_packets[wic_write_packet].num_vertices = 0;
+    wic_packets[wic_write_packet].num_instances = 0;
+    wic_packets[wic_write_packet].num_meshes = 0;
+    wic_packets[wic_write_packet].num_views = 0;
+    wic_packets[wic_write_packet].view = wic_render_view;
+    wic_packets[wic_write_packet].num_commands = 0;
+}
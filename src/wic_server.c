@@ -18,15 +18,39 @@
  * File:    wic_server.c
  * ----------------------------------------------------------------------------
  */
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
 #include "wic_server.h"
+/* the number of datagrams received per batch */
+#define WIC_RECV_BATCH 32
 static int wic_socket;
 static struct sockaddr_in wic_addr;
 static socklen_t wic_size_addr = sizeof(wic_addr);
 static struct sockaddr_in* addrs;
 static uint8_t wic_buffer[sizeof(WicPacket)];
-static size_t wic_size_buffer = sizeof(wic_buffer);
 static bool wic_initialized = false;
 static WicPacket wic_packet;
+static bool wic_coalescing = false;
+static uint8_t* wic_queues;
+static size_t* wic_len_queues;
+static uint8_t* wic_recv_buffer;
+static size_t wic_len_recvs[WIC_RECV_BATCH];
+static struct sockaddr_in wic_recv_addrs[WIC_RECV_BATCH];
+static unsigned wic_num_recv = 0;
+static unsigned wic_recv_index = 0;
+static size_t wic_recv_offset = 0;
+static WicConnection* wic_connections;
+static double* wic_closing_times;
+static WicNodeIndex wic_ordered_index = 0;
+/* how long a kicked or banned client's slot is held for its last packets to
+ * be acknowledged */
+static const double wic_linger_time = 2.0;
+#ifdef __linux__
+static struct mmsghdr wic_msgs[255];
+static struct iovec wic_iovs[255];
+static unsigned wic_num_msgs = 0;
+#endif
 char** wic_alloc_string_array(unsigned num_string, unsigned size_string)
 {
     char** result = malloc(num_string * sizeof(char*));
@@ -125,6 +149,30 @@ bool wic_init_server(WicServer* target, char* name, unsigned port,
         wic_throw_error(WIC_ERRNO_NO_HEAP);
     }
     inet_ntop(AF_INET, &wic_addr.sin_addr, ips[0], INET_ADDRSTRLEN);
+    /* one datagram queue per node plus the receive batch */
+    wic_queues = malloc((max_nodes + WIC_RECV_BATCH) * WIC_MAX_DATAGRAM_SIZE);
+    wic_len_queues = calloc(max_nodes, sizeof(size_t));
+    wic_connections = calloc(max_nodes, sizeof(WicConnection));
+    wic_closing_times = calloc(max_nodes, sizeof(double));
+    if(!wic_queues || !wic_len_queues || !wic_connections || !wic_closing_times)
+    {
+        close(wic_socket);
+        free(addrs);
+        free(used);
+        wic_free_string_array(names, max_nodes);
+        wic_free_string_array(ips, max_nodes);
+        free(wic_queues);
+        free(wic_len_queues);
+        free(wic_connections);
+        free(wic_closing_times);
+        return wic_throw_error(WIC_ERRNO_NO_HEAP);
+    }
+    wic_recv_buffer = wic_queues + max_nodes * WIC_MAX_DATAGRAM_SIZE;
+    wic_num_recv = 0;
+    wic_recv_index = 0;
+    wic_recv_offset = 0;
+    wic_ordered_index = 0;
+    wic_coalescing = false;
     
     target->name = name;
     target->max_nodes = max_nodes;
@@ -135,6 +183,160 @@ bool wic_init_server(WicServer* target, char* name, unsigned port,
     target->blacklist = 0;
     return true;
 }
+/* adds a datagram to the outgoing batch; sent immediately without sendmmsg */
+void wic_server_batch_datagram(uint8_t* datagram, size_t size,
+                               WicNodeIndex index)
+{
+#ifdef __linux__
+    struct msghdr* header = &wic_msgs[wic_num_msgs].msg_hdr;
+    wic_iovs[wic_num_msgs].iov_base = datagram;
+    wic_iovs[wic_num_msgs].iov_len = size;
+    bzero(header, sizeof(struct msghdr));
+    header->msg_name = &addrs[index];
+    header->msg_namelen = wic_size_addr;
+    header->msg_iov = &wic_iovs[wic_num_msgs];
+    header->msg_iovlen = 1;
+    wic_num_msgs++;
+#else
+    sendto(wic_socket, datagram, size, 0, (struct sockaddr*) &addrs[index],
+           wic_size_addr);
+#endif
+}
+/* sends the outgoing batch with as few syscalls as possible */
+void wic_server_send_batch()
+{
+#ifdef __linux__
+    WIC_PROFILE_BEGIN("wic_server_send_batch");
+    unsigned sent = 0;
+    while(sent < wic_num_msgs)
+    {
+        int result = sendmmsg(wic_socket, &wic_msgs[sent], wic_num_msgs - sent,
+                              0);
+        if(result < 0)
+        {
+            /* skip the datagram that failed, as a failed sendto would */
+            if(errno != EINTR)
+                sent++;
+            continue;
+        }
+        sent += result;
+    }
+    wic_num_msgs = 0;
+    WIC_PROFILE_END("wic_server_send_batch");
+#endif
+}
+/* sends and empties a node's datagram queue */
+void wic_server_flush_queue(WicNodeIndex index)
+{
+    if(!wic_len_queues[index])
+        return;
+    wic_server_batch_datagram(&wic_queues[index * WIC_MAX_DATAGRAM_SIZE],
+                              wic_len_queues[index], index);
+    wic_server_send_batch();
+    wic_len_queues[index] = 0;
+}
+/* sends a packet to every used client but one (0 excludes none), converting
+ * it only once */
+void wic_server_fan_out(WicServer* target, WicPacket* packet,
+                        WicNodeIndex exclude_index)
+{
+    if(wic_coalescing)
+    {
+        for(WicNodeIndex i = 1; i < target->max_nodes; i++)
+        {
+            if(i != exclude_index && target->used[i])
+                wic_server_send_packet(target, packet, i);
+        }
+        return;
+    }
+    WIC_PROFILE_BEGIN("wic_server_fan_out");
+    size_t size = WIC_PACKET_HEADER_SIZE + packet->type.size;
+    wic_convert_packet_to_buffer(wic_buffer, packet);
+    for(WicNodeIndex i = 1; i < target->max_nodes; i++)
+    {
+        if(i != exclude_index && target->used[i])
+            wic_server_batch_datagram(wic_buffer, size, i);
+    }
+    wic_server_send_batch();
+    WIC_PROFILE_END("wic_server_fan_out");
+}
+bool wic_server_flush(WicServer* target)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    
+    for(WicNodeIndex i = 1; i < target->max_nodes; i++)
+    {
+        if(wic_len_queues[i])
+        {
+            wic_server_batch_datagram(&wic_queues[i * WIC_MAX_DATAGRAM_SIZE],
+                                      wic_len_queues[i], i);
+        }
+    }
+    wic_server_send_batch();
+    bzero(wic_len_queues, target->max_nodes * sizeof(size_t));
+    return true;
+}
+/* sends one or two packets to a node in a single datagram, or queues them
+ * together while coalescing */
+void wic_server_send_records(WicNodeIndex index, WicPacket* first,
+                             WicPacket* second)
+{
+    size_t len_first = WIC_PACKET_HEADER_SIZE + first->type.size;
+    size_t size = len_first;
+    if(second)
+        size += WIC_PACKET_HEADER_SIZE + second->type.size;
+    if(wic_coalescing)
+    {
+        if(wic_len_queues[index] + size > WIC_MAX_DATAGRAM_SIZE)
+            wic_server_flush_queue(index);
+        uint8_t* queue = &wic_queues[index * WIC_MAX_DATAGRAM_SIZE +
+                                     wic_len_queues[index]];
+        wic_convert_packet_to_buffer(queue, first);
+        if(second)
+            wic_convert_packet_to_buffer(queue + len_first, second);
+        wic_len_queues[index] += size;
+        return;
+    }
+    uint8_t datagram[2 * sizeof(WicPacket)];
+    wic_convert_packet_to_buffer(datagram, first);
+    if(second)
+        wic_convert_packet_to_buffer(datagram + len_first, second);
+    wic_server_batch_datagram(datagram, size, index);
+    wic_server_send_batch();
+}
+/* sends a packet to a node over its reliable ordered channel */
+bool wic_server_send_reliable(WicNodeIndex index, WicPacket* packet)
+{
+    WicPacket header;
+    if(!wic_connection_wrap(&wic_connections[index],
+                            WIC_CHANNEL_RELIABLE_ORDERED, packet,
+                            wic_get_channel_time(), &header))
+        return false;
+    wic_server_send_records(index, &header, packet);
+    return true;
+}
+/* sends a packet to all connected clients but one over their reliable ordered
+ * channels */
+void wic_server_send_reliable_exclude(WicServer* target, WicPacket* packet,
+                                      WicNodeIndex exclude_index)
+{
+    for(WicNodeIndex i = 1; i < target->max_nodes; i++)
+    {
+        if(i != exclude_index && target->used[i])
+            wic_server_send_reliable(i, packet);
+    }
+}
+bool wic_server_set_coalescing(WicServer* target, bool coalescing)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    
+    if(!coalescing)
+        wic_server_flush(target);
+    wic_coalescing = coalescing;
+    return true;
+}
 bool wic_server_send_packet(WicServer* target, WicPacket* packet,
                             WicNodeIndex dest_index)
 {
@@ -149,151 +351,373 @@ bool wic_server_send_packet(WicServer* target, WicPacket* packet,
     
     if(target->used[dest_index])
     {
-        size_t size = WIC_PACKET_HEADER_SIZE + packet->type.size;
-        wic_convert_packet_to_buffer(wic_buffer, packet);
-        sendto(wic_socket, wic_buffer, size, 0,
-               (struct sockaddr*) &addrs[dest_index],
-               wic_size_addr);
+        WIC_PROFILE_BEGIN("wic_server_send_packet");
+        wic_server_send_records(dest_index, packet, 0);
+        WIC_PROFILE_END("wic_server_send_packet");
         return true;
     }
     return wic_throw_error(WIC_ERRNO_INDEX_UNUSED);
 }
-bool wic_server_send_packet_exclude(WicServer* target, WicPacket* packet,
-                                    WicNodeIndex exclude_index)
+bool wic_server_send_channel_packet(WicServer* target, WicPacket* packet,
+                                    WicNodeIndex dest_index,
+                                    enum WicChannel channel)
 {
     if(!target)
         return wic_throw_error(WIC_ERRNO_NULL_TARGET);
     if(!packet)
         return wic_throw_error(WIC_ERRNO_NULL_PACKET);
-    if(exclude_index < 1)
+    if(dest_index < 1)
         return wic_throw_error(WIC_ERRNO_NOT_CLIENT_INDEX);
-    if(exclude_index >= target->max_nodes)
+    if(dest_index >= target->max_nodes)
         return wic_throw_error(WIC_ERRNO_IMPOSSIBLE_INDEX);
+    if(!target->used[dest_index])
+        return wic_throw_error(WIC_ERRNO_INDEX_UNUSED);
+    
+    WIC_PROFILE_BEGIN("wic_server_send_channel_packet");
+    WicPacket header;
+    bool result = wic_connection_wrap(&wic_connections[dest_index], channel,
+                                      packet, wic_get_channel_time(), &header);
+    if(result)
+        wic_server_send_records(dest_index, &header, packet);
+    WIC_PROFILE_END("wic_server_send_channel_packet");
+    return result;
+}
+bool wic_server_update_channels(WicServer* target)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
     
+    WIC_PROFILE_BEGIN("wic_server_update_channels");
+    double now = wic_get_channel_time();
+    WicPacket header;
+    WicPacket* packet;
     for(WicNodeIndex i = 1; i < target->max_nodes; i++)
     {
-        if(i != exclude_index && target->used[i])
-            wic_server_send_packet(target, packet, i);
+        if(!target->used[i] && !wic_closing_times[i])
+            continue;
+        WicConnection* connection = &wic_connections[i];
+        while(wic_connection_get_resend(connection, now, &header, &packet))
+            wic_server_send_records(i, &header, packet);
+        while(wic_connection_get_ack(connection, &header))
+        {
+            header.sender_index = WIC_SERVER_INDEX;
+            wic_server_send_records(i, &header, 0);
+        }
+        if(wic_closing_times[i] && (!wic_connection_has_unacked(connection) ||
+                                    now > wic_closing_times[i]))
+            wic_closing_times[i] = 0;
     }
+    WIC_PROFILE_END("wic_server_update_channels");
     return true;
 }
-bool wic_server_send_packet_all(WicServer* target, WicPacket* packet)
+WicConnection* wic_server_get_connection(WicServer* target,
+                                         WicNodeIndex client_index)
+{
+    if(!target)
+        return (void*) wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(client_index < 1)
+        return (void*) wic_throw_error(WIC_ERRNO_NOT_CLIENT_INDEX);
+    if(client_index >= target->max_nodes)
+        return (void*) wic_throw_error(WIC_ERRNO_IMPOSSIBLE_INDEX);
+    if(!target->used[client_index])
+        return (void*) wic_throw_error(WIC_ERRNO_INDEX_UNUSED);
+    
+    return &wic_connections[client_index];
+}
+bool wic_server_send_packet_exclude(WicServer* target, WicPacket* packet,
+                                    WicNodeIndex exclude_index)
 {
     if(!target)
         return wic_throw_error(WIC_ERRNO_NULL_TARGET);
     if(!packet)
         return wic_throw_error(WIC_ERRNO_NULL_PACKET);
+    if(exclude_index < 1)
+        return wic_throw_error(WIC_ERRNO_NOT_CLIENT_INDEX);
+    if(exclude_index >= target->max_nodes)
+        return wic_throw_error(WIC_ERRNO_IMPOSSIBLE_INDEX);
     
-    for(WicNodeIndex i = 1; i < target->max_nodes; i++)
-    {
-        if(target->used[i])
-            wic_server_send_packet(target, packet, i);
-    }
+    wic_server_fan_out(target, packet, exclude_index);
     return true;
 }
-bool wic_server_recv_packet(WicServer* target, WicPacket* result)
+bool wic_server_send_packet_all(WicServer* target, WicPacket* packet)
 {
     if(!target)
         return wic_throw_error(WIC_ERRNO_NULL_TARGET);
-    if(!result)
-        return wic_throw_error(WIC_ERRNO_NULL_RESULT);
+    if(!packet)
+        return wic_throw_error(WIC_ERRNO_NULL_PACKET);
     
-    struct sockaddr_in recv_addr;
-    socklen_t len_recv_addr = sizeof(recv_addr);
-    ssize_t length = recvfrom(wic_socket, wic_buffer, wic_size_buffer, 0,
-                              (struct sockaddr*) &recv_addr, &len_recv_addr);
-    if(length > 0)
+    wic_server_fan_out(target, packet, 0);
+    return true;
+}
+/* receives the next batch of datagrams; returns how many arrived */
+unsigned wic_server_recv_batch()
+{
+    WIC_PROFILE_BEGIN("wic_server_recv_batch");
+#ifdef __linux__
+    struct mmsghdr msgs[WIC_RECV_BATCH];
+    struct iovec iovs[WIC_RECV_BATCH];
+    bzero(msgs, sizeof(msgs));
+    for(unsigned i = 0; i < WIC_RECV_BATCH; i++)
     {
-        WicNodeIndex index;
-        wic_get_packet_from_buffer(wic_buffer, result);
-        if(result->type.id == WIC_PACKET_REQUEST_JOIN.id)
+        iovs[i].iov_base = &wic_recv_buffer[i * WIC_MAX_DATAGRAM_SIZE];
+        iovs[i].iov_len = WIC_MAX_DATAGRAM_SIZE;
+        msgs[i].msg_hdr.msg_name = &wic_recv_addrs[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    int num = recvmmsg(wic_socket, msgs, WIC_RECV_BATCH, 0, 0);
+    wic_num_recv = num > 0 ? num : 0;
+    for(unsigned i = 0; i < wic_num_recv; i++)
+        wic_len_recvs[i] = msgs[i].msg_len;
+#else
+    socklen_t len_recv_addr = sizeof(struct sockaddr_in);
+    ssize_t length = recvfrom(wic_socket, wic_recv_buffer,
+                              WIC_MAX_DATAGRAM_SIZE, 0,
+                              (struct sockaddr*) &wic_recv_addrs[0],
+                              &len_recv_addr);
+    wic_num_recv = length > 0;
+    wic_len_recvs[0] = length > 0 ? length : 0;
+#endif
+    WIC_PROFILE_END("wic_server_recv_batch");
+    wic_recv_index = 0;
+    wic_recv_offset = 0;
+    return wic_num_recv;
+}
+/* fetches the next received packet and its source, receiving another batch
+ * once the last one has been read; returns whether there was one */
+bool wic_server_next_packet(WicPacket* result, struct sockaddr_in* source)
+{
+    while(wic_recv_index < wic_num_recv || wic_server_recv_batch())
+    {
+        size_t len_recv = wic_len_recvs[wic_recv_index];
+        if(wic_recv_offset < len_recv)
         {
-            wic_packet.type = WIC_PACKET_RESPOND_JOIN;
-            char ip[INET_ADDRSTRLEN];
-            inet_ntop(AF_INET, &recv_addr.sin_addr, &ip[0], INET_ADDRSTRLEN);
-            for(unsigned i = 0; i < target->len_blacklist; i++)
-            {
-                if(!strcmp(&ip[0], target->blacklist[i]) ||
-                    !strcmp((char*) &result->data[0], target->blacklist[i]))
-                {
-                    wic_packet.data[0] = WIC_PACKET_RESPOND_JOIN_BANNED;
-                    size_t size = WIC_PACKET_HEADER_SIZE + wic_packet.type.size;
-                    wic_convert_packet_to_buffer(wic_buffer, &wic_packet);
-                    sendto(wic_socket, wic_buffer, size, 0,
-                           (struct sockaddr*) &recv_addr, wic_size_addr);
-                    return false;
-                }
-            }
-            uint8_t connections = 0;
-            for(WicNodeIndex i = 1; i < target->max_nodes; i++)
-            {
-                if(target->used[i])
-                    connections++;
-            }
-            if(connections == target->max_nodes - 1)
+            *source = wic_recv_addrs[wic_recv_index];
+            /* a malformed datagram is dropped from the bad record on */
+            if(wic_get_packet_from_datagram(&wic_recv_buffer[wic_recv_index *
+                                                WIC_MAX_DATAGRAM_SIZE],
+                                            len_recv, &wic_recv_offset, result))
+                return true;
+        }
+        wic_recv_index++;
+        wic_recv_offset = 0;
+    }
+    return false;
+}
+/* fetches the next packet of the datagram the last packet came from */
+bool wic_server_next_in_datagram(WicPacket* result)
+{
+    if(wic_recv_index >= wic_num_recv)
+        return false;
+    return wic_get_packet_from_datagram(&wic_recv_buffer[wic_recv_index *
+                                            WIC_MAX_DATAGRAM_SIZE],
+                                        wic_len_recvs[wic_recv_index],
+                                        &wic_recv_offset, result);
+}
+/* determines whether a packet came from a connected or closing client */
+bool wic_server_is_connected(WicServer* target, WicNodeIndex index,
+                             struct sockaddr_in* source)
+{
+    return index > 0 && index < target->max_nodes &&
+           (target->used[index] || wic_closing_times[index]) &&
+           source->sin_addr.s_addr == addrs[index].sin_addr.s_addr &&
+           source->sin_port == addrs[index].sin_port;
+}
+/* fetches the next packet to deliver, unwrapping channel packets and
+ * consuming acks along the way; returns whether there was one */
+bool wic_server_next_message(WicServer* target, WicPacket* result,
+                             struct sockaddr_in* source)
+{
+    if(wic_ordered_index)
+    {
+        if(wic_connection_next_ordered(&wic_connections[wic_ordered_index],
+                                       result))
+        {
+            *source = addrs[wic_ordered_index];
+            return true;
+        }
+        wic_ordered_index = 0;
+    }
+    while(wic_server_next_packet(result, source))
+    {
+        if(result->type.id != WIC_PACKET_CHANNEL.id &&
+           result->type.id != WIC_PACKET_ACK.id)
+            return true;
+        WicNodeIndex index = result->sender_index;
+        if(!wic_server_is_connected(target, index, source))
+            return true;
+        WicConnection* connection = &wic_connections[index];
+        double now = wic_get_channel_time();
+        if(result->type.id == WIC_PACKET_ACK.id)
+        {
+            wic_connection_receive_ack(connection, result, now);
+            continue;
+        }
+        /* the channel's packet follows its header in the same datagram */
+        WicPacket header = *result;
+        if(!wic_server_next_in_datagram(result))
+            continue;
+        if(wic_connection_unwrap(connection, &header, result, now) &&
+           target->used[index])
+        {
+            wic_ordered_index = index;
+            return true;
+        }
+    }
+    return false;
+}
+/* handles joins and leaves and checks the source of a received packet */
+bool wic_server_process_packet(WicServer* target, WicPacket* result,
+                               struct sockaddr_in recv_addr)
+{
+    WicNodeIndex index;
+    if(result->type.id == WIC_PACKET_REQUEST_JOIN.id)
+    {
+        wic_packet.type = WIC_PACKET_RESPOND_JOIN;
+        char ip[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &recv_addr.sin_addr, &ip[0], INET_ADDRSTRLEN);
+        for(unsigned i = 0; i < target->len_blacklist; i++)
+        {
+            if(!strcmp(&ip[0], target->blacklist[i]) ||
+                !strcmp((char*) &result->data[0], target->blacklist[i]))
             {
-                wic_packet.data[0] = WIC_PACKET_RESPOND_JOIN_FULL;
+                wic_packet.data[0] = WIC_PACKET_RESPOND_JOIN_BANNED;
                 size_t size = WIC_PACKET_HEADER_SIZE + wic_packet.type.size;
                 wic_convert_packet_to_buffer(wic_buffer, &wic_packet);
                 sendto(wic_socket, wic_buffer, size, 0,
                        (struct sockaddr*) &recv_addr, wic_size_addr);
                 return false;
             }
-            wic_packet.data[0] = WIC_PACKET_RESPOND_JOIN_OKAY;
-            wic_packet.data[1] = target->max_nodes;
-            for(WicNodeIndex i = 0; i < target->max_nodes; i++)
-            {
-                if(!target->used[i])
-                {
-                    index = i;
-                    wic_packet.data[2] = i;
-                    break;
-                }
-            }
-            strcpy((char*) &wic_packet.data[3], target->name);
-            addrs[index] = recv_addr;
-            target->used[index] = true;
-            strcpy(target->names[index], (char*) result->data);
-            inet_ntop(AF_INET, &recv_addr.sin_addr, target->ips[index],
-                      INET_ADDRSTRLEN);
-            wic_server_send_packet(target, &wic_packet, index);
-            
-            wic_packet.type = WIC_PACKET_CLIENT_JOINED;
-            wic_packet.data[0] = index;
-            strcpy((char*) &wic_packet.data[1], target->names[index]);
-            wic_server_send_packet_exclude(target, &wic_packet, index);
-            memcpy(result, &wic_packet, sizeof(WicPacket));
-            wic_packet.type = WIC_PACKET_IN_CLIENT;
-            for(WicNodeIndex i = 1; i < target->max_nodes; i++)
+        }
+        uint8_t connections = 0;
+        for(WicNodeIndex i = 1; i < target->max_nodes; i++)
+        {
+            if(target->used[i] || wic_closing_times[i])
+                connections++;
+        }
+        if(connections == target->max_nodes - 1)
+        {
+            wic_packet.data[0] = WIC_PACKET_RESPOND_JOIN_FULL;
+            size_t size = WIC_PACKET_HEADER_SIZE + wic_packet.type.size;
+            wic_convert_packet_to_buffer(wic_buffer, &wic_packet);
+            sendto(wic_socket, wic_buffer, size, 0,
+                   (struct sockaddr*) &recv_addr, wic_size_addr);
+            return false;
+        }
+        wic_packet.data[0] = WIC_PACKET_RESPOND_JOIN_OKAY;
+        wic_packet.data[1] = target->max_nodes;
+        for(WicNodeIndex i = 0; i < target->max_nodes; i++)
+        {
+            if(!target->used[i] && !wic_closing_times[i])
             {
-                if(target->used[i])
-                {
-                    wic_packet.data[0] = i;
-                    strcpy((char*) &wic_packet.data[1], target->names[i]);
-                    wic_server_send_packet(target, &wic_packet, index);
-                }
+                index = i;
+                wic_packet.data[2] = i;
+                break;
             }
-            return true;
         }
-        index = wic_buffer[0];
-        if(index > 0 && index < target->max_nodes && target->used[index] &&
-           recv_addr.sin_addr.s_addr == addrs[index].sin_addr.s_addr &&
-           recv_addr.sin_port == addrs[index].sin_port)
+        strcpy((char*) &wic_packet.data[3], target->name);
+        addrs[index] = recv_addr;
+        target->used[index] = true;
+        wic_reset_connection(&wic_connections[index]);
+        strcpy(target->names[index], (char*) result->data);
+        inet_ntop(AF_INET, &recv_addr.sin_addr, target->ips[index],
+                  INET_ADDRSTRLEN);
+        wic_server_send_packet(target, &wic_packet, index);
+        
+        wic_packet.type = WIC_PACKET_CLIENT_JOINED;
+        wic_packet.data[0] = index;
+        strcpy((char*) &wic_packet.data[1], target->names[index]);
+        wic_server_send_reliable_exclude(target, &wic_packet, index);
+        memcpy(result, &wic_packet, sizeof(WicPacket));
+        wic_packet.type = WIC_PACKET_IN_CLIENT;
+        for(WicNodeIndex i = 1; i < target->max_nodes; i++)
         {
-            if(result->type.id == WIC_PACKET_LEAVE.id)
+            if(target->used[i])
             {
-                wic_packet.type = WIC_PACKET_CLIENT_LEFT;
-                wic_packet.data[0] = index;
-                wic_packet.data[1] = WIC_PACKET_CLIENT_LEFT_NORMALLY;
-                wic_packet.data[2] = '\0';
-                wic_server_send_packet_exclude(target, &wic_packet, index);
-                target->used[index] = false;
+                wic_packet.data[0] = i;
+                strcpy((char*) &wic_packet.data[1], target->names[i]);
+                wic_server_send_reliable(index, &wic_packet);
             }
-            return true;
         }
-        return wic_throw_error(WIC_ERRNO_PACKET_UNKNOWN_SOURCE);
+        wic_server_flush_queue(index);
+        return true;
     }
-    return false;
+    index = result->sender_index;
+    if(index > 0 && index < target->max_nodes && target->used[index] &&
+       recv_addr.sin_addr.s_addr == addrs[index].sin_addr.s_addr &&
+       recv_addr.sin_port == addrs[index].sin_port)
+    {
+        if(result->type.id == WIC_PACKET_LEAVE.id)
+        {
+            wic_packet.type = WIC_PACKET_CLIENT_LEFT;
+            wic_packet.data[0] = index;
+            wic_packet.data[1] = WIC_PACKET_CLIENT_LEFT_NORMALLY;
+            wic_packet.data[2] = '\0';
+            wic_server_send_reliable_exclude(target, &wic_packet, index);
+            wic_len_queues[index] = 0;
+            target->used[index] = false;
+            if(wic_ordered_index == index)
+                wic_ordered_index = 0;
+        }
+        return true;
+    }
+    return wic_throw_error(WIC_ERRNO_PACKET_UNKNOWN_SOURCE);
+}
+bool wic_server_recv_packet(WicServer* target, WicPacket* result)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!result)
+        return wic_throw_error(WIC_ERRNO_NULL_RESULT);
+    
+    struct sockaddr_in recv_addr;
+    if(!wic_server_next_message(target, result, &recv_addr))
+        return false;
+    return wic_server_process_packet(target, result, recv_addr);
+}
+unsigned wic_server_recv_packets(WicServer* target, WicPacket* results,
+                                 unsigned max_results)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!results)
+        return wic_throw_error(WIC_ERRNO_NULL_RESULT);
+    
+    unsigned num_results = 0;
+    struct sockaddr_in recv_addr;
+    while(num_results < max_results &&
+          wic_server_next_message(target, &results[num_results], &recv_addr))
+    {
+        if(wic_server_process_packet(target, &results[num_results], recv_addr))
+            num_results++;
+    }
+    return num_results;
+}
+bool wic_server_wait(WicServer* target, double timeout)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    
+    if(wic_recv_index + 1 < wic_num_recv || (wic_recv_index < wic_num_recv &&
+       wic_recv_offset < wic_len_recvs[wic_recv_index]))
+        return true;
+    if(wic_ordered_index &&
+       wic_connection_has_ordered(&wic_connections[wic_ordered_index]))
+        return true;
+    WIC_PROFILE_BEGIN("wic_server_wait");
+    bool ready = wic_wait_socket(wic_socket, timeout);
+    WIC_PROFILE_END("wic_server_wait");
+    return ready;
+}
+int wic_server_get_socket(WicServer* target)
+{
+    if(!target)
+    {
+        wic_throw_error(WIC_ERRNO_NULL_TARGET);
+        return -1;
+    }
+    return wic_socket;
 }
 bool wic_server_kick_client(WicServer* target, WicNodeIndex client_index,
                             char* reason)
@@ -311,13 +735,17 @@ bool wic_server_kick_client(WicServer* target, WicNodeIndex client_index,
     
     wic_packet.type = WIC_PACKET_KICK_CLIENT;
     strcpy((char*) &wic_packet.data[0], reason);
-    wic_server_send_packet(target, &wic_packet, client_index);
+    wic_server_send_reliable(client_index, &wic_packet);
     wic_packet.type = WIC_PACKET_CLIENT_LEFT;
     wic_packet.data[0] = client_index;
     wic_packet.data[1] = WIC_PACKET_CLIENT_LEFT_KICKED;
     strcpy((char*) &wic_packet.data[2], reason);
-    wic_server_send_packet_exclude(target, &wic_packet, client_index);
+    wic_server_send_reliable_exclude(target, &wic_packet, client_index);
+    wic_server_flush_queue(client_index);
     target->used[client_index] = false;
+    if(wic_ordered_index == client_index)
+        wic_ordered_index = 0;
+    wic_closing_times[client_index] = wic_get_channel_time() + wic_linger_time;
     return true;
 }
 bool wic_server_ban(WicServer* target, char* name_or_ip)
@@ -369,13 +797,17 @@ bool wic_server_ban_client(WicServer* target, WicNodeIndex client_index,
     
     wic_packet.type = WIC_PACKET_BAN_CLIENT;
     strcpy((char*) &wic_packet.data[0], reason);
-    wic_server_send_packet(target, &wic_packet, client_index);
+    wic_server_send_reliable(client_index, &wic_packet);
     wic_packet.type = WIC_PACKET_CLIENT_LEFT;
     wic_packet.data[0] = client_index;
     wic_packet.data[1] = WIC_PACKET_CLIENT_LEFT_BANNED;
     strcpy((char*) &wic_packet.data[2], reason);
-    wic_server_send_packet_exclude(target, &wic_packet, client_index);
+    wic_server_send_reliable_exclude(target, &wic_packet, client_index);
+    wic_server_flush_queue(client_index);
     target->used[client_index] = false;
+    if(wic_ordered_index == client_index)
+        wic_ordered_index = 0;
+    wic_closing_times[client_index] = wic_get_channel_time() + wic_linger_time;
     return true;
 }
 bool wic_server_unban(WicServer* target, char* name_or_ip)
@@ -432,9 +864,15 @@ bool wic_free_server(WicServer* target)
     
     wic_packet.type = WIC_PACKET_SERVER_SHUTDOWN;
     wic_server_send_packet_all(target, &wic_packet);
+    wic_server_flush(target);
     
     close(wic_socket);
     free(addrs);
+    free(wic_queues);
+    free(wic_len_queues);
+    free(wic_connections);
+    free(wic_closing_times);
+    wic_coalescing = false;
     target->name = 0;
     free(target->used);
     target->used = 0;
@@ -0,0 +1,333 @@
+/* ----------------------------------------------------------------------------
+ * wic - a simple 2D game engine for Mac OSX written in C
+ * Copyright (C) 2013-2017  Willis O'Leary
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * ----------------------------------------------------------------------------
+ * File:    wic_snapshot.c
+ * ----------------------------------------------------------------------------
+ */
+#include "wic_snapshot.h"
+/* the bytes before the entities in a WIC_PACKET_SNAPSHOT */
+static const uint8_t wic_snapshot_header_size = 7;
+void wic_write_u16(uint8_t* buffer, uint16_t value);
+uint16_t wic_read_u16(uint8_t* buffer);
+bool wic_is_newer_seq(uint16_t a, uint16_t b);
+/* the number of entities that fit in one WIC_PACKET_SNAPSHOT */
+unsigned wic_get_entities_per_packet(uint16_t entity_size)
+{
+    return (WIC_PACKET_SNAPSHOT.size - wic_snapshot_header_size) /
+           (2 + entity_size);
+}
+/* validates entity dimensions and allocates the history shared by both ends */
+bool wic_init_snapshots(WicSnapshots* target, uint16_t entity_size,
+                        uint16_t num_entities, unsigned num_states)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(entity_size < 1)
+        return wic_throw_error(WIC_ERRNO_SMALL_ENTITY_SIZE);
+    if(wic_get_entities_per_packet(entity_size) < 1)
+        return wic_throw_error(WIC_ERRNO_LARGE_ENTITY_SIZE);
+    if(num_entities < 1)
+        return wic_throw_error(WIC_ERRNO_SMALL_NUM_ENTITIES);
+    unsigned per_packet = wic_get_entities_per_packet(entity_size);
+    if((num_entities + per_packet - 1) / per_packet > 255)
+        return wic_throw_error(WIC_ERRNO_LARGE_SNAPSHOT);
+    
+    bzero(target, sizeof(WicSnapshots));
+    target->states = malloc(num_states * entity_size * num_entities);
+    if(!target->states)
+        return wic_throw_error(WIC_ERRNO_NO_HEAP);
+    target->entity_size = entity_size;
+    target->num_entities = num_entities;
+    return true;
+}
+bool wic_init_server_snapshots(WicSnapshots* target, WicServer* server,
+                               uint16_t entity_size, uint16_t num_entities)
+{
+    if(!server)
+        return wic_throw_error(WIC_ERRNO_NULL_SERVER);
+    if(!wic_init_snapshots(target, entity_size, num_entities,
+                           WIC_SNAPSHOT_HISTORY))
+        return false;
+    target->acked = calloc(server->max_nodes, sizeof(bool));
+    target->acked_seqs = calloc(server->max_nodes, sizeof(uint16_t));
+    target->fragments = malloc(255 * sizeof(WicPacket));
+    if(!target->acked || !target->acked_seqs || !target->fragments)
+    {
+        wic_free_snapshots(target);
+        return wic_throw_error(WIC_ERRNO_NO_HEAP);
+    }
+    target->max_nodes = server->max_nodes;
+    return true;
+}
+bool wic_init_client_snapshots(WicSnapshots* target, uint16_t entity_size,
+                               uint16_t num_entities)
+{
+    /* the snapshot being rebuilt lives after the history */
+    if(!wic_init_snapshots(target, entity_size, num_entities,
+                           WIC_SNAPSHOT_HISTORY + 1))
+        return false;
+    target->pending = target->states +
+                      WIC_SNAPSHOT_HISTORY * entity_size * num_entities;
+    return true;
+}
+/* gets a snapshot in the history by sequence number, or 0 if it is gone */
+uint8_t* wic_get_snapshot(WicSnapshots* target, uint16_t seq)
+{
+    unsigned slot = seq % WIC_SNAPSHOT_HISTORY;
+    if(!target->valid[slot] || target->seqs[slot] != seq)
+        return 0;
+    return target->states + slot * target->entity_size * target->num_entities;
+}
+/* stores a snapshot in the history, replacing the oldest */
+void wic_store_snapshot(WicSnapshots* target, uint8_t* state, uint16_t seq)
+{
+    unsigned slot = seq % WIC_SNAPSHOT_HISTORY;
+    size_t size = target->entity_size * target->num_entities;
+    memcpy(target->states + slot * size, state, size);
+    target->seqs[slot] = seq;
+    target->valid[slot] = true;
+}
+/* gets the baseline a client's deltas are encoded against, or 0 for none */
+uint8_t* wic_get_baseline(WicSnapshots* target, WicNodeIndex index)
+{
+    if(!target->acked[index])
+        return 0;
+    return wic_get_snapshot(target, target->acked_seqs[index]);
+}
+/* encodes the entities of state that differ from baseline, or every entity
+   without a baseline, into fragments; returns the number of fragments */
+unsigned wic_encode_snapshot(WicSnapshots* target, uint8_t* state,
+                             uint16_t seq, uint8_t* baseline,
+                             uint16_t baseline_seq)
+{
+    unsigned per_packet = wic_get_entities_per_packet(target->entity_size);
+    unsigned num_fragments = 0;
+    unsigned count = per_packet;
+    WicPacket* fragment = 0;
+    for(unsigned i = 0; i < target->num_entities; i++)
+    {
+        uint8_t* entity = state + i * target->entity_size;
+        if(baseline && !memcmp(entity, baseline + i * target->entity_size,
+                               target->entity_size))
+            continue;
+        if(count == per_packet)
+        {
+            fragment = &target->fragments[num_fragments++];
+            fragment->type.size = wic_snapshot_header_size;
+            count = 0;
+        }
+        uint8_t* record = &fragment->data[fragment->type.size];
+        wic_write_u16(record, i);
+        memcpy(record + 2, entity, target->entity_size);
+        fragment->type.size += 2 + target->entity_size;
+        count++;
+    }
+    /* an unchanged world still sends one empty fragment to advance the seq */
+    if(!num_fragments)
+        target->fragments[num_fragments++].type.size = wic_snapshot_header_size;
+    for(unsigned i = 0; i < num_fragments; i++)
+    {
+        fragment = &target->fragments[i];
+        fragment->sender_index = WIC_SERVER_INDEX;
+        fragment->type.id = WIC_PACKET_SNAPSHOT.id;
+        wic_write_u16(&fragment->data[0], seq);
+        wic_write_u16(&fragment->data[2], baseline_seq);
+        fragment->data[4] = baseline != 0;
+        fragment->data[5] = i;
+        fragment->data[6] = num_fragments;
+    }
+    return num_fragments;
+}
+bool wic_server_send_snapshot(WicServer* server, WicSnapshots* target,
+                              void* state)
+{
+    if(!server)
+        return wic_throw_error(WIC_ERRNO_NULL_SERVER);
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!state)
+        return wic_throw_error(WIC_ERRNO_NULL_BUFFER);
+    
+    WIC_PROFILE_BEGIN("wic_server_send_snapshot");
+    uint16_t seq = target->next_seq++;
+    wic_store_snapshot(target, state, seq);
+    bool done[256] = {0};
+    for(WicNodeIndex i = 1; i < target->max_nodes; i++)
+    {
+        if(!server->used[i])
+            target->acked[i] = false;
+        if(!server->used[i] || done[i])
+            continue;
+        /* encode once for every client sharing this client's baseline */
+        uint8_t* baseline = wic_get_baseline(target, i);
+        unsigned num_fragments = wic_encode_snapshot(target, state, seq,
+                                                     baseline,
+                                                     target->acked_seqs[i]);
+        for(WicNodeIndex j = i; j < target->max_nodes; j++)
+        {
+            if(!server->used[j] || done[j] ||
+               wic_get_baseline(target, j) != baseline)
+                continue;
+            for(unsigned k = 0; k < num_fragments; k++)
+                wic_server_send_packet(server, &target->fragments[k], j);
+            done[j] = true;
+        }
+    }
+    WIC_PROFILE_END("wic_server_send_snapshot");
+    return true;
+}
+bool wic_server_process_snapshot_ack(WicSnapshots* target, WicPacket* packet)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!packet)
+        return wic_throw_error(WIC_ERRNO_NULL_PACKET);
+    
+    WicNodeIndex index = packet->sender_index;
+    if(packet->type.id == WIC_PACKET_CLIENT_JOINED.id)
+    {
+        /* a new client in a reused slot has none of the old one's baselines */
+        if(packet->data[0] < target->max_nodes)
+            target->acked[packet->data[0]] = false;
+        return false;
+    }
+    if(packet->type.id != WIC_PACKET_SNAPSHOT_ACK.id ||
+       packet->type.size != WIC_PACKET_SNAPSHOT_ACK.size ||
+       index < 1 || index >= target->max_nodes)
+        return false;
+    
+    uint16_t seq = wic_read_u16(&packet->data[0]);
+    if(!packet->data[2])
+        target->acked[index] = false;
+    else if(wic_get_snapshot(target, seq) &&
+            wic_is_newer_seq(target->next_seq, seq) &&
+            (!target->acked[index] ||
+             wic_is_newer_seq(seq, target->acked_seqs[index])))
+    {
+        target->acked[index] = true;
+        target->acked_seqs[index] = seq;
+    }
+    return true;
+}
+/* tells the server a snapshot was rebuilt, or that its baseline was missing */
+void wic_send_snapshot_ack(WicClient* client, uint16_t seq, bool rebuilt)
+{
+    WicPacket ack;
+    ack.type = WIC_PACKET_SNAPSHOT_ACK;
+    wic_write_u16(&ack.data[0], seq);
+    ack.data[2] = rebuilt;
+    wic_client_send_packet(client, &ack);
+}
+/* starts rebuilding a snapshot from its baseline; false if it is missing */
+bool wic_begin_snapshot(WicSnapshots* target, WicPacket* packet)
+{
+    size_t size = target->entity_size * target->num_entities;
+    target->assembling = true;
+    target->broken = false;
+    target->pending_seq = wic_read_u16(&packet->data[0]);
+    target->num_fragments = packet->data[6];
+    target->num_received = 0;
+    bzero(target->received, sizeof(target->received));
+    if(!packet->data[4])
+    {
+        bzero(target->pending, size);
+        return true;
+    }
+    uint8_t* baseline = wic_get_snapshot(target,
+                                         wic_read_u16(&packet->data[2]));
+    if(!baseline)
+    {
+        target->broken = true;
+        return false;
+    }
+    memcpy(target->pending, baseline, size);
+    return true;
+}
+bool wic_client_process_snapshot(WicClient* client, WicSnapshots* target,
+                                 WicPacket* packet, void* result)
+{
+    if(!client)
+        return wic_throw_error(WIC_ERRNO_NULL_CLIENT);
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!packet)
+        return wic_throw_error(WIC_ERRNO_NULL_PACKET);
+    if(!result)
+        return wic_throw_error(WIC_ERRNO_NULL_RESULT);
+    
+    size_t record_size = 2 + target->entity_size;
+    if(packet->type.id != WIC_PACKET_SNAPSHOT.id ||
+       packet->type.size < wic_snapshot_header_size ||
+       (packet->type.size - wic_snapshot_header_size) % record_size ||
+       packet->data[5] >= packet->data[6])
+        return false;
+    uint16_t seq = wic_read_u16(&packet->data[0]);
+    if(target->has_latest && !wic_is_newer_seq(seq, target->latest_seq))
+        return false;
+    
+    WIC_PROFILE_BEGIN("wic_client_process_snapshot");
+    if(!target->assembling || wic_is_newer_seq(seq, target->pending_seq))
+    {
+        /* a newer snapshot supersedes an incomplete one */
+        if(!wic_begin_snapshot(target, packet))
+            wic_send_snapshot_ack(client, target->latest_seq, false);
+    }
+    if(seq != target->pending_seq || target->broken ||
+       target->received[packet->data[5]] ||
+       target->num_fragments != packet->data[6])
+    {
+        WIC_PROFILE_END("wic_client_process_snapshot");
+        return false;
+    }
+    for(size_t i = wic_snapshot_header_size; i < packet->type.size;
+        i += record_size)
+    {
+        uint16_t entity = wic_read_u16(&packet->data[i]);
+        if(entity < target->num_entities)
+            memcpy(target->pending + entity * target->entity_size,
+                   &packet->data[i + 2], target->entity_size);
+    }
+    target->received[packet->data[5]] = true;
+    target->num_received++;
+    if(target->num_received < target->num_fragments)
+    {
+        WIC_PROFILE_END("wic_client_process_snapshot");
+        return false;
+    }
+    
+    wic_store_snapshot(target, target->pending, seq);
+    memcpy(result, target->pending,
+           target->entity_size * target->num_entities);
+    target->assembling = false;
+    target->has_latest = true;
+    target->latest_seq = seq;
+    wic_send_snapshot_ack(client, seq, true);
+    WIC_PROFILE_END("wic_client_process_snapshot");
+    return true;
+}
+bool wic_free_snapshots(WicSnapshots* target)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    
+    free(target->states);
+    free(target->acked);
+    free(target->acked_seqs);
+    free(target->fragments);
+    bzero(target, sizeof(WicSnapshots));
+    return true;
+}
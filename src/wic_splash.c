@@ -10,6 +10,13 @@ struct WicGame
     double previous_time;
     double delta;
     FT_Library freetype_library;
+    enum WicPaceMode pace_mode;
+    double next_frame_time;
+    double sleep_overshoot;
+    unsigned* frame_histogram;
+    unsigned num_frames;
+    double min_frame_time;
+    double total_frame_time;
     
 };
 bool wic_draw_splash(WicColor background_color, WicColor text_color,
@@ -0,0 +1,283 @@
+/* ----------------------------------------------------------------------------
+ * wic - a simple 2D game engine for Mac OSX written in C
+ * Copyright (C) 2013-2017  Willis O'Leary
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * ----------------------------------------------------------------------------
+ * File:    wic_sprite_batch.c
+ * ----------------------------------------------------------------------------
+ */
+#include "wic_sprite_batch.h"
+#define WIC_PARALLEL_SPRITES 1024
+struct WicTexture
+{
+    unsigned int data;
+    WicPair dimensions;
+    unsigned channels;
+    enum WicTextureStatus status;
+};
+struct WicGame
+{
+    GLFWwindow* window;
+    WicPair dimensions;
+    WicPair pixel_density;
+    double seconds_per_frame;
+    double previous_time;
+    double delta;
+    FT_Library freetype_library;
+    enum WicPaceMode pace_mode;
+    double next_frame_time;
+    double sleep_overshoot;
+    unsigned* frame_histogram;
+    unsigned num_frames;
+    double min_frame_time;
+    double total_frame_time;
+    
+};
+typedef struct WicVertex
+{
+    GLfloat x;
+    GLfloat y;
+    GLfloat u;
+    GLfloat v;
+    WicColor color;
+} WicVertex;
+bool wic_render_is_recording();
+WicVertex* wic_render_add(unsigned texture, GLenum mode, unsigned num_vertices);
+typedef struct WicSpriteTransform
+{
+    WicSpriteBatch* batch;        /**< the batch being added to */
+    unsigned start;               /**< the index of the first new image */
+} WicSpriteTransform;
+struct WicSpriteBatch
+{
+    WicVertex* vertices;     /**< the vertices, four per image */
+    WicTexture** textures;   /**< the texture of each image */
+    WicImage** sources;      /**< the images of a bulk add being transformed */
+    unsigned capacity;       /**< the maximum number of images */
+    unsigned num_images;     /**< the number of images currently held */
+    unsigned num_drawn;      /**< the number of images drawn */
+    unsigned num_draws;      /**< the number of draw calls issued */
+};
+void wic_image_get_quad(WicImage* target, WicPair* vertices,
+                        WicPair* tex_coords);
+WicSpriteBatch* wic_init_sprite_batch(unsigned capacity)
+{
+    if(!capacity)
+        return (void*) wic_throw_error(WIC_ERRNO_SMALL_CAPACITY);
+    WicVertex* vertices = malloc(capacity * 4 * sizeof(WicVertex));
+    if(!vertices)
+        return (void*) wic_throw_error(WIC_ERRNO_NO_HEAP);
+    WicTexture** textures = malloc(capacity * sizeof(WicTexture*));
+    if(!textures)
+    {
+        free(vertices);
+        return (void*) wic_throw_error(WIC_ERRNO_NO_HEAP);
+    }
+    WicImage** sources = malloc(capacity * sizeof(WicImage*));
+    if(!sources)
+    {
+        free(vertices);
+        free(textures);
+        return (void*) wic_throw_error(WIC_ERRNO_NO_HEAP);
+    }
+    WicSpriteBatch* result = malloc(sizeof(WicSpriteBatch));
+    if(!result)
+    {
+        free(vertices);
+        free(textures);
+        free(sources);
+        return (void*) wic_throw_error(WIC_ERRNO_NO_HEAP);
+    }
+    result->vertices = vertices;
+    result->textures = textures;
+    result->sources = sources;
+    result->capacity = capacity;
+    result->num_images = 0;
+    result->num_drawn = 0;
+    result->num_draws = 0;
+    return result;
+}
+/* writes the quad of an image into four vertices */
+void wic_sprite_batch_write(WicVertex* vertex, WicImage* image)
+{
+    WicPair vertices[4];
+    WicPair tex_coords[4];
+    wic_image_get_quad(image, vertices, tex_coords);
+    for(unsigned i = 0; i < 4; i++)
+    {
+        vertex[i].x = vertices[i].x;
+        vertex[i].y = vertices[i].y;
+        vertex[i].u = tex_coords[i].x;
+        vertex[i].v = tex_coords[i].y;
+        vertex[i].color = image->color;
+    }
+}
+bool wic_sprite_batch_add_image(WicSpriteBatch* target, WicImage* image,
+                                WicGame* game)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!image)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!image->texture)
+        return wic_throw_error(WIC_ERRNO_NULL_TEXTURE);
+    if(!game)
+        return wic_throw_error(WIC_ERRNO_NULL_GAME);
+    if(image->texture->status != WIC_TEXTURE_READY)
+        return true;
+    if(target->num_images == target->capacity)
+        wic_draw_sprite_batch(target);
+    
+    wic_sprite_batch_write(&target->vertices[target->num_images * 4], image);
+    target->textures[target->num_images] = image->texture;
+    target->num_images++;
+    return true;
+}
+/* writes the quads of sources [start, end) of a bulk add */
+void wic_sprite_batch_transform(unsigned start, unsigned end, void* argument)
+{
+    WicSpriteTransform* transform = argument;
+    WicSpriteBatch* batch = transform->batch;
+    for(unsigned i = start; i < end; i++)
+        wic_sprite_batch_write(&batch->vertices[(transform->start + i) * 4],
+                               batch->sources[i]);
+}
+bool wic_sprite_batch_add_images(WicSpriteBatch* target, WicImage* images,
+                                 unsigned num_images, WicGame* game)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!images)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!game)
+        return wic_throw_error(WIC_ERRNO_NULL_GAME);
+    for(unsigned i = 0; i < num_images; i++)
+    {
+        if(!images[i].texture)
+            return wic_throw_error(WIC_ERRNO_NULL_TEXTURE);
+    }
+    unsigned i = 0;
+    while(i < num_images)
+    {
+        if(target->num_images == target->capacity)
+            wic_draw_sprite_batch(target);
+        WicSpriteTransform transform = {target, target->num_images};
+        unsigned num_added = 0;
+        for(; i < num_images && target->num_images < target->capacity; i++)
+        {
+            if(images[i].texture->status != WIC_TEXTURE_READY)
+                continue;
+            target->sources[num_added++] = &images[i];
+            target->textures[target->num_images++] = images[i].texture;
+        }
+        /* small runs are not worth the overhead of splitting */
+        if(num_added < WIC_PARALLEL_SPRITES ||
+           !wic_parallel_for(num_added, 0, wic_sprite_batch_transform,
+                             &transform))
+            wic_sprite_batch_transform(0, num_added, &transform);
+    }
+    return true;
+}
+/* records a batch into the render thread's frame packet */
+bool wic_sprite_batch_record(WicSpriteBatch* target)
+{
+    unsigned start = 0;
+    for(unsigned i = 1; i <= target->num_images; i++)
+    {
+        if(i == target->num_images ||
+           target->textures[i] != target->textures[start])
+        {
+            unsigned num_vertices = (i - start) * 4;
+            WicVertex* vertices = wic_render_add(target->textures[start]->data,
+                                                 GL_QUADS, num_vertices);
+            if(!vertices)
+                return false;
+            memcpy(vertices, &target->vertices[start * 4],
+                   num_vertices * sizeof(WicVertex));
+            target->num_draws++;
+            start = i;
+        }
+    }
+    target->num_drawn += target->num_images;
+    target->num_images = 0;
+    return true;
+}
+bool wic_draw_sprite_batch(WicSpriteBatch* target)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    if(!target->num_images)
+        return true;
+    if(wic_render_is_recording())
+        return wic_sprite_batch_record(target);
+    
+    glEnable(GL_TEXTURE_2D);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(WicVertex), &target->vertices[0].x);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(WicVertex), &target->vertices[0].u);
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(WicVertex),
+                   &target->vertices[0].color);
+    unsigned start = 0;
+    for(unsigned i = 1; i <= target->num_images; i++)
+    {
+        if(i == target->num_images ||
+           target->textures[i] != target->textures[start])
+        {
+            glBindTexture(GL_TEXTURE_2D, target->textures[start]->data);
+            glDrawArrays(GL_QUADS, start * 4, (i - start) * 4);
+            target->num_draws++;
+            start = i;
+        }
+    }
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisable(GL_TEXTURE_2D);
+    target->num_drawn += target->num_images;
+    target->num_images = 0;
+    return true;
+}
+unsigned wic_sprite_batch_get_draws(WicSpriteBatch* target)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    return target->num_draws;
+}
+unsigned wic_sprite_batch_get_saved_draws(WicSpriteBatch* target)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    return target->num_drawn - target->num_draws;
+}
+bool wic_sprite_batch_reset_stats(WicSpriteBatch* target)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    target->num_drawn = 0;
+    target->num_draws = 0;
+    return true;
+}
+bool wic_free_sprite_batch(WicSpriteBatch* target)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    free(target->vertices);
+    free(target->textures);
+    free(target->sources);
+    free(target);
+    return true;
+}
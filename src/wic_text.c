@@ -19,22 +19,72 @@
  * ----------------------------------------------------------------------------
  */
 #include "wic_text.h"
+struct WicGame
+{
+    GLFWwindow* window;
+    WicPair dimensions;
+    WicPair pixel_density;
+    double seconds_per_frame;
+    double previous_time;
+    double delta;
+    FT_Library freetype_library;
+    enum WicPaceMode pace_mode;
+    double next_frame_time;
+    double sleep_overshoot;
+    unsigned* frame_histogram;
+    unsigned num_frames;
+    double min_frame_time;
+    double total_frame_time;
+    
+};
 struct WicTexture
 {
     unsigned int data;
     WicPair dimensions;
+    unsigned channels;
+    enum WicTextureStatus status;
 };
 struct WicFont
 {
     FT_Face face;           /**< the face */
-    WicTexture** textures;   /**< the glyph textures */
+    WicAtlas* atlas;        /**< the glyph atlas */
+    WicTexture* texture;    /**< the glyph atlas texture */
+    WicBounds* glyphs;      /**< the bounds of each glyph within texture; 
+                             *   empty for glyphs with no bitmap */
     unsigned short point;   /**< the point size measured in font points */
     bool antialias;         /**< whether or not to antialias the font */
 };
-static WicImage working_image;
-/* populates offsets and images and return the bounds */
-WicBounds wic_text_get_data(WicPair* offsets, WicImage* images,
-                            WicPair location, char* string, size_t len_string,
+typedef struct WicVertex
+{
+    GLfloat x;
+    GLfloat y;
+    GLfloat u;
+    GLfloat v;
+    WicColor color;
+} WicVertex;
+struct WicTextMesh
+{
+    WicVertex* vertices;     /**< the glyph quads */
+    unsigned buffer;         /**< the GPU vertex buffer */
+    unsigned num_vertices;   /**< the number of vertices in buffer */
+    bool uploaded;           /**< whether or not buffer matches vertices */
+    bool valid;              /**< whether or not buffer matches the string */
+    WicPair location;        /**< the location buffer was built with */
+    WicPair center;          /**< the center buffer was built with */
+    double rotation;         /**< the rotation buffer was built with */
+    WicPair scale;           /**< the scale buffer was built with */
+    WicBounds bounds;        /**< the bounds buffer was built with */
+    WicColor color;          /**< the color buffer was built with */
+    bool draw_centered;      /**< the centering buffer was built with */
+};
+void wic_image_get_quad(WicImage* target, WicPair* vertices,
+                        WicPair* tex_coords);
+bool wic_render_is_recording();
+WicVertex* wic_render_add(unsigned texture, GLenum mode, unsigned num_vertices);
+void wic_render_call(void (*function)(void*), void* data);
+bool wic_render_cull(WicBounds bounds);
+/* populates offsets and returns the bounds */
+WicBounds wic_text_get_data(WicPair* offsets, char* string, size_t len_string,
                             WicFont* font)
 {
     double x = 0, min_y = 0, max_y = 0;
@@ -62,17 +112,6 @@ WicBounds wic_text_get_data(WicPair* offsets, WicImage* images,
         if(font->face->glyph->metrics.horiBearingY > max_y)
             max_y = font->face->glyph->metrics.horiBearingY;
     }
-    for(size_t i = 0; i < len_string; i++)
-    {
-        char c = string[i];
-        if(c == ' ')
-            images[i].texture = 0;
-        else
-        {
-            wic_init_image(&images[i], location, font->textures[c]);
-            images[i].draw_centered = true;
-        }
-    }
     return (WicBounds) {(WicPair) {0, min_y / 64}, (WicPair) {x, max_y / 64}};
 }
 bool wic_init_text(WicText* target, WicPair location, char* string,
@@ -88,14 +127,13 @@ bool wic_init_text(WicText* target, WicPair location, char* string,
     WicPair* offsets = malloc(sizeof(WicPair) * len_string);
     if(!offsets)
         return wic_throw_error(WIC_ERRNO_NO_HEAP);
-    WicImage* images = malloc(sizeof(WicImage) * len_string);
-    if(!images)
+    WicTextMesh* mesh = calloc(1, sizeof(WicTextMesh));
+    if(!mesh)
     {
         free(offsets);
         return wic_throw_error(WIC_ERRNO_NO_HEAP);
     }
-    WicBounds bounds = wic_text_get_data(offsets, images, location, string,
-                                         len_string, font);
+    WicBounds bounds = wic_text_get_data(offsets, string, len_string, font);
     
     target->location = location;
     target->center = (WicPair) {0,0};
@@ -107,7 +145,7 @@ bool wic_init_text(WicText* target, WicPair location, char* string,
     target->string = string;
     target->len_string = len_string;
     target->offsets = offsets;
-    target->images = images;
+    target->mesh = mesh;
     target->font = font;
     return true;
 }
@@ -121,21 +159,104 @@ bool wic_text_set_string(WicText* target, char* string, size_t len_string)
     WicPair* offsets = malloc(sizeof(WicPair) * len_string);
     if(!offsets)
         return wic_throw_error(WIC_ERRNO_NO_HEAP);
-    WicImage* images = malloc(sizeof(WicImage) * len_string);
-    if(!images)
-    {
-        free(offsets);
-        return wic_throw_error(WIC_ERRNO_NO_HEAP);
-    }
-    WicBounds bounds = wic_text_get_data(offsets, images, target->location,
-                                         string, len_string, target->font);
+    WicBounds bounds = wic_text_get_data(offsets, string, len_string,
+                                         target->font);
     free(target->offsets);
-    free(target->images);
     target->string = string;
     target->len_string = len_string;
     target->bounds = bounds;
     target->offsets = offsets;
-    target->images = images;
+    target->mesh->valid = false;
+    return true;
+}
+/* determines whether or not the mesh was built from the text's current state */
+bool wic_text_is_mesh_current(WicText* target)
+{
+    WicTextMesh* mesh = target->mesh;
+    return mesh->valid &&
+           mesh->location.x == target->location.x &&
+           mesh->location.y == target->location.y &&
+           mesh->center.x == target->center.x &&
+           mesh->center.y == target->center.y &&
+           mesh->rotation == target->rotation &&
+           mesh->scale.x == target->scale.x &&
+           mesh->scale.y == target->scale.y &&
+           !memcmp(&mesh->bounds, &target->bounds, sizeof(WicBounds)) &&
+           !memcmp(&mesh->color, &target->color, sizeof(WicColor)) &&
+           mesh->draw_centered == target->draw_centered;
+}
+/* uploads the mesh's glyph quads to its GPU vertex buffer */
+bool wic_text_upload_mesh(WicTextMesh* mesh)
+{
+    if(!mesh->buffer)
+        glGenBuffers(1, &mesh->buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh->buffer);
+    glBufferData(GL_ARRAY_BUFFER, mesh->num_vertices * sizeof(WicVertex),
+                 mesh->vertices, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if(glGetError() == GL_OUT_OF_MEMORY)
+        return wic_throw_error(WIC_ERRNO_NO_GPU_MEM);
+    mesh->uploaded = true;
+    return true;
+}
+/* deletes the mesh's GPU vertex buffer */
+void wic_text_delete_buffer(void* mesh)
+{
+    glDeleteBuffers(1, &((WicTextMesh*) mesh)->buffer);
+}
+/* rebuilds the mesh's glyph quads from the text's current state */
+bool wic_text_build_mesh(WicText* target)
+{
+    WicTextMesh* mesh = target->mesh;
+    WicVertex* vertices = malloc(target->len_string * 4 * sizeof(WicVertex));
+    if(target->len_string && !vertices)
+        return wic_throw_error(WIC_ERRNO_NO_HEAP);
+    WicPair location = target->location;
+    if(target->draw_centered)
+        location = wic_subtract_pairs(location, target->center);
+    WicImage glyph;
+    unsigned num_vertices = 0;
+    for(size_t i = 0; i < target->len_string; i++)
+    {
+        unsigned char c = target->string[i];
+        if(c == ' ' || c >= 128)
+            continue;
+        WicBounds bounds = target->font->glyphs[c];
+        if(wic_are_pairs_equal(bounds.lower_left, bounds.upper_right))
+            continue;
+        /* shifting the center moves the glyph to its place in the text */
+        WicPair shift = wic_add_pairs(target->bounds.lower_left,
+                                      target->offsets[i]);
+        wic_init_image(&glyph, location, target->font->texture);
+        glyph.center = wic_add_pairs(target->center, shift);
+        glyph.rotation = target->rotation;
+        glyph.scale = target->scale;
+        glyph.bounds = bounds;
+        glyph.draw_centered = true;
+        WicPair quad[4];
+        WicPair tex_coords[4];
+        wic_image_get_quad(&glyph, quad, tex_coords);
+        for(unsigned j = 0; j < 4; j++)
+        {
+            vertices[num_vertices] = (WicVertex) {quad[j].x, quad[j].y,
+                                                  tex_coords[j].x,
+                                                  tex_coords[j].y,
+                                                  target->color};
+            num_vertices++;
+        }
+    }
+    free(mesh->vertices);
+    mesh->vertices = vertices;
+    mesh->num_vertices = num_vertices;
+    mesh->uploaded = false;
+    mesh->valid = true;
+    mesh->location = target->location;
+    mesh->center = target->center;
+    mesh->rotation = target->rotation;
+    mesh->scale = target->scale;
+    mesh->bounds = target->bounds;
+    mesh->color = target->color;
+    mesh->draw_centered = target->draw_centered;
     return true;
 }
 bool wic_draw_text(WicText* target, WicGame* game)
@@ -144,30 +265,66 @@ bool wic_draw_text(WicText* target, WicGame* game)
         return wic_throw_error(WIC_ERRNO_NULL_TARGET);
     if(!game)
         return wic_throw_error(WIC_ERRNO_NULL_GAME);
-    for(unsigned i = 0; i < target->len_string; i++)
+    /* glyphs are placed around location, shifted back by center when drawn
+     * centered */
+    WicPair location = target->location;
+    if(target->draw_centered)
+        location = wic_subtract_pairs(location, target->center);
+    WicPair diagonal = wic_subtract_pairs(target->bounds.upper_right,
+                                          target->bounds.lower_left);
+    if(wic_render_cull(wic_get_drawable_bounds(location, target->center,
+                                               target->rotation, target->scale,
+                                               true,
+                                               (WicBounds) {(WicPair) {0,0},
+                                                            diagonal})))
+        return true;
+    WIC_PROFILE_BEGIN("wic_draw_text");
+    if(!wic_text_is_mesh_current(target) && !wic_text_build_mesh(target))
     {
-        if(target->images[i].texture != 0)
-        {
-            double height = target->images[i].texture->dimensions.y;
-            WicBounds bounds;
-            bounds.lower_left = wic_add_pairs(target->bounds.lower_left,
-                                              target->offsets[i]);
-            bounds.upper_right = wic_add_pairs(target->bounds.upper_right,
-                                               target->offsets[i]); 
-            target->images[i].bounds = bounds;
-            
-            WicPair location = target->location;
-            if(target->draw_centered)
-                location = wic_subtract_pairs(location, target->center);
-            target->images[i].location = location;
-            
-            target->images[i].rotation = target->rotation;
-            target->images[i].scale = target->scale;
-            target->images[i].center.x = target->center.x;
-            target->images[i].center.y = target->center.y;
-            wic_draw_image(&target->images[i], game);
-        }
+        WIC_PROFILE_END("wic_draw_text");
+        return false;
+    }
+    if(!target->mesh->num_vertices)
+    {
+        WIC_PROFILE_END("wic_draw_text");
+        return true;
     }
+    if(wic_render_is_recording())
+    {
+        WicVertex* vertices = wic_render_add(target->font->texture->data,
+                                             GL_QUADS,
+                                             target->mesh->num_vertices);
+        if(vertices)
+            memcpy(vertices, target->mesh->vertices,
+                   target->mesh->num_vertices * sizeof(WicVertex));
+        WIC_PROFILE_END("wic_draw_text");
+        return vertices != 0;
+    }
+    if(!target->mesh->uploaded && !wic_text_upload_mesh(target->mesh))
+    {
+        WIC_PROFILE_END("wic_draw_text");
+        return false;
+    }
+    
+    glBindBuffer(GL_ARRAY_BUFFER, target->mesh->buffer);
+    glBindTexture(GL_TEXTURE_2D, target->font->texture->data);
+    glEnable(GL_TEXTURE_2D);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(WicVertex),
+                    (void*) offsetof(WicVertex, x));
+    glTexCoordPointer(2, GL_FLOAT, sizeof(WicVertex),
+                      (void*) offsetof(WicVertex, u));
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(WicVertex),
+                   (void*) offsetof(WicVertex, color));
+    glDrawArrays(GL_QUADS, 0, target->mesh->num_vertices);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisable(GL_TEXTURE_2D);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    WIC_PROFILE_END("wic_draw_text");
     return true;
 }
 bool wic_free_text(WicText* target)
@@ -175,7 +332,10 @@ bool wic_free_text(WicText* target)
     if(!target)
         return wic_throw_error(WIC_ERRNO_NULL_TARGET);
     free(target->offsets);
-    free(target->images);
+    if(target->mesh->buffer)
+        wic_render_call(wic_text_delete_buffer, target->mesh);
+    free(target->mesh->vertices);
+    free(target->mesh);
     
     target->location = (WicPair) {0,0};
     target->center = (WicPair) {0,0};
@@ -187,7 +347,7 @@ bool wic_free_text(WicText* target)
     target->string = 0;
     target->len_string = 0;
     target->offsets = 0;
-    target->images = 0;
+    target->mesh = 0;
     target->font = 0;
     return true;
 }
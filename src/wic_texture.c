@@ -19,137 +19,337 @@
  * ----------------------------------------------------------------------------
  */
 #include "wic_texture.h"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#define WIC_PARALLEL_FORMAT_PIXELS (512 * 512)
 struct WicTexture
 {
     unsigned int data;
     WicPair dimensions;
+    unsigned channels;
+    enum WicTextureStatus status;
 };
-WicTexture* wic_init_texture_from_buffer(unsigned char* buffer,
-                                         WicPair dimensions,
-                                         enum WicFormat format,
-                                         enum WicFilter filter,
-                                         enum WicWrap wrap)
+typedef struct WicTextureJob
 {
-    if(!buffer)
-        return (void*) wic_throw_error(WIC_ERRNO_NULL_BUFFER);
-    if(dimensions.x < 1)
-        return (void*) wic_throw_error(WIC_ERRNO_SMALL_X_DIMENSION);
-    if(dimensions.y < 1)
-        return (void*) wic_throw_error(WIC_ERRNO_SMALL_Y_DIMENSION);
-    int x_dimension = (int) (dimensions.x) * 4;
-    int y_dimension = (int) dimensions.y;
-    unsigned char** temp = malloc(x_dimension * sizeof(unsigned char*));
-    if(!temp)
-        return (void*) wic_throw_error(WIC_ERRNO_NO_HEAP);
-    for(int x = 0; x < x_dimension; x++)
+    WicTexture* texture;          /**< the texture being loaded */
+    char* filepath;               /**< a copy of the filepath */
+    enum WicFilter filter;        /**< the texture filter */
+    enum WicWrap wrap;            /**< the texture wrap */
+    WicTextureCallback callback;  /**< the completion callback, may be null */
+    void* data;                   /**< the user data passed to callback */
+    unsigned char* pixels;        /**< the decoded, formatted pixels */
+    WicPair dimensions;           /**< the decoded dimensions */
+    struct WicTextureJob* next;   /**< the next job in the same queue */
+} WicTextureJob;
+typedef struct WicTextureCall
+{
+    unsigned char* buffer;        /**< the formatted pixels, may be null */
+    WicPair dimensions;           /**< the dimensions of buffer */
+    WicPair offset;               /**< the texel offset of an update */
+    unsigned channels;            /**< the number of channels in buffer */
+    enum WicFilter filter;        /**< the texture filter */
+    enum WicWrap wrap;            /**< the texture wrap */
+    WicTextureJob* job;           /**< the job to upload */
+    unsigned data;                /**< the GL texture, in or out */
+} WicTextureCall;
+void wic_render_call(void (*function)(void*), void* data);
+bool wic_render_is_core();
+static pthread_mutex_t wic_loader_mutex = PTHREAD_MUTEX_INITIALIZER;
+static WicTextureJob* wic_decoded_head = 0;
+static WicTextureJob* wic_decoded_tail = 0;
+static double wic_upload_budget = 0.002;
+static unsigned wic_pixel_buffer = 0;
+/* thresholds a row of mono values into 8 bit alpha values */
+void wic_format_mono_row(unsigned char* row, unsigned char* result, int width)
+{
+    int x = 0;
+#if defined(__AVX2__)
+    const __m256i zero = _mm256_setzero_si256();
+    for(; x + 32 <= width; x += 32)
     {
-        temp[x] = malloc(y_dimension * sizeof(unsigned char));
-        if(!temp[x])
-        {
-            for(int i = x-1; i < 0; i--)
-                free(temp[i]);
-            free(temp);
-            return (void*) wic_throw_error(WIC_ERRNO_NO_HEAP);
-        }
+        __m256i values = _mm256_loadu_si256((__m256i*) &row[x]);
+        __m256i alpha = _mm256_andnot_si256(_mm256_cmpeq_epi8(values, zero),
+                                            _mm256_set1_epi8(-1));
+        _mm256_storeu_si256((__m256i*) &result[x], alpha);
     }
-    for(int y = 0; y < y_dimension; y++)
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for(; x + 16 <= width; x += 16)
     {
-        for(int x = 0; x < x_dimension; x+=4)
-        {
-            temp[x][y] = 255;
-            temp[x+1][y] = 255;
-            temp[x+2][y] = 255;
-            temp[x+3][y] = 0;
-        }
+        __m128i values = _mm_loadu_si128((__m128i*) &row[x]);
+        __m128i alpha = _mm_andnot_si128(_mm_cmpeq_epi8(values, zero),
+                                         _mm_set1_epi8(-1));
+        _mm_storeu_si128((__m128i*) &result[x], alpha);
     }
-    int buffer_index = 0;
-    for(int y = 0; y < y_dimension; y++)
+#endif
+    for(; x < width; x++)
+        result[x] = row[x] ? 255 : 0;
+}
+/* expands a row of 8 bit alpha values into RGBA pixels */
+void wic_format_alpha_row(unsigned char* row, uint32_t* result, int width,
+                          bool mono)
+{
+    int x = 0;
+#if defined(__AVX2__)
+    const __m256i white = _mm256_set1_epi32(0x00FFFFFF);
+    const __m128i zero = _mm_setzero_si128();
+    for(; x + 8 <= width; x += 8)
     {
-        for(int x = 0; x < x_dimension; x+=4)
-        {
-            if(format == WIC_MONO)
-            {
-                unsigned char character = buffer[buffer_index];
-                if(!character)
-                    temp[x+3][y] = 0;
-                else
-                    temp[x+3][y] = 255;
-                buffer_index++;
-            }
-            else if(format == WIC_GREYSCALE)
-            {
-                temp[x+3][y] = buffer[buffer_index];
-                buffer_index++;
-            }
-            else if(format == WIC_RGB)
-            {
-                temp[x][y] = buffer[buffer_index];
-                temp[x+1][y] = buffer[buffer_index+1];
-                temp[x+2][y] = buffer[buffer_index+2];
-                temp[x+3][y] = 255;
-                buffer_index += 3;
-            }
-            else if(format == WIC_RGBA)
-            {
-                temp[x][y] = buffer[buffer_index];
-                temp[x+1][y] = buffer[buffer_index+1];
-                temp[x+2][y] = buffer[buffer_index+2];
-                temp[x+3][y] = buffer[buffer_index+3];
-                buffer_index += 4;
-            }
-        }
+        __m128i alpha = _mm_loadl_epi64((__m128i*) &row[x]);
+        if(mono)
+            alpha = _mm_andnot_si128(_mm_cmpeq_epi8(alpha, zero),
+                                     _mm_set1_epi8(-1));
+        __m256i pixels = _mm256_slli_epi32(_mm256_cvtepu8_epi32(alpha), 24);
+        _mm256_storeu_si256((__m256i*) &result[x],
+                            _mm256_or_si256(pixels, white));
     }
-    unsigned char* formatted_buffer = malloc(x_dimension * y_dimension *
-                                             sizeof(unsigned char));
-    if(!formatted_buffer)
+#elif defined(__SSE2__)
+    const __m128i white = _mm_set1_epi32(0x00FFFFFF);
+    const __m128i zero = _mm_setzero_si128();
+    for(; x + 16 <= width; x += 16)
     {
-        for(int x = 0; x < x_dimension; x++)
-            free(temp[x]);
-        free(temp);
-        return (void*) wic_throw_error(WIC_ERRNO_NO_HEAP);
+        __m128i alpha = _mm_loadu_si128((__m128i*) &row[x]);
+        if(mono)
+            alpha = _mm_andnot_si128(_mm_cmpeq_epi8(alpha, zero),
+                                     _mm_set1_epi8(-1));
+        __m128i low = _mm_unpacklo_epi8(zero, alpha);
+        __m128i high = _mm_unpackhi_epi8(zero, alpha);
+        _mm_storeu_si128((__m128i*) &result[x],
+                         _mm_or_si128(_mm_unpacklo_epi16(zero, low), white));
+        _mm_storeu_si128((__m128i*) &result[x+4],
+                         _mm_or_si128(_mm_unpackhi_epi16(zero, low), white));
+        _mm_storeu_si128((__m128i*) &result[x+8],
+                         _mm_or_si128(_mm_unpacklo_epi16(zero, high), white));
+        _mm_storeu_si128((__m128i*) &result[x+12],
+                         _mm_or_si128(_mm_unpackhi_epi16(zero, high), white));
     }
-    int formatted_buffer_index = 0;
-    for(int y = y_dimension-1; y >= 0; y--) /* flips texture */
+#endif
+    unsigned char* bytes = (unsigned char*) result;
+    for(; x < width; x++)
     {
-        for(int x = 0; x < x_dimension; x++)
-        {
-            formatted_buffer[formatted_buffer_index] = temp[x][y];
-            formatted_buffer_index++;
-        }
+        bytes[x*4] = 255;
+        bytes[x*4+1] = 255;
+        bytes[x*4+2] = 255;
+        if(mono)
+            bytes[x*4+3] = row[x] ? 255 : 0;
+        else
+            bytes[x*4+3] = row[x];
     }
-    for(int x = 0; x < x_dimension; x++)
-        free(temp[x]);
-    free(temp);
-    unsigned int data;
-    glGenTextures(1, &data);
-    glBindTexture(GL_TEXTURE_2D, data);
-    if(wrap == WIC_STOP)
+}
+/* expands a row of RGB pixels into RGBA pixels */
+void wic_format_rgb_row(unsigned char* row, uint32_t* result, int width)
+{
+    int x = 0;
+#if defined(__SSSE3__)
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1,
+                                          6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i opaque = _mm_set1_epi32(0xFF000000);
+    /* each load reads 16 bytes but only consumes 4 pixels (12 bytes) */
+    for(; x + 6 <= width; x += 4)
+    {
+        __m128i pixels = _mm_loadu_si128((__m128i*) &row[x*3]);
+        pixels = _mm_shuffle_epi8(pixels, shuffle);
+        _mm_storeu_si128((__m128i*) &result[x], _mm_or_si128(pixels, opaque));
+    }
+#endif
+    unsigned char* bytes = (unsigned char*) result;
+    for(; x < width; x++)
+    {
+        bytes[x*4] = row[x*3];
+        bytes[x*4+1] = row[x*3+1];
+        bytes[x*4+2] = row[x*3+2];
+        bytes[x*4+3] = 255;
+    }
+}
+typedef struct WicFormatRows
+{
+    unsigned char* buffer;        /**< the source pixels */
+    unsigned char* result;        /**< the formatted pixels */
+    WicPair dimensions;           /**< the dimensions of buffer */
+    enum WicFormat format;        /**< the format of buffer */
+    unsigned channels;            /**< the number of channels in result */
+} WicFormatRows;
+/* formats rows [start, end) of a buffer, flipping them */
+void wic_format_rows(unsigned start, unsigned end, void* argument)
+{
+    WicFormatRows* rows = argument;
+    int width = (int) rows->dimensions.x;
+    int height = (int) rows->dimensions.y;
+    enum WicFormat format = rows->format;
+    unsigned channels = rows->channels;
+    size_t size_pixel = 4;
+    if(format == WIC_MONO || format == WIC_GREYSCALE)
+        size_pixel = 1;
+    else if(format == WIC_RGB)
+        size_pixel = 3;
+    for(int y = start; y < (int) end; y++) /* flips texture */
+    {
+        unsigned char* row = rows->buffer + (size_t) y * width * size_pixel;
+        unsigned char* result_row = rows->result + (size_t) (height-1-y) *
+                                                   width * channels;
+        if(channels == 1 && format == WIC_MONO)
+            wic_format_mono_row(row, result_row, width);
+        else if(channels == 1)
+            memcpy(result_row, row, width);
+        else if(format == WIC_MONO || format == WIC_GREYSCALE)
+            wic_format_alpha_row(row, (uint32_t*) result_row, width,
+                                 format == WIC_MONO);
+        else if(format == WIC_RGB)
+            wic_format_rgb_row(row, (uint32_t*) result_row, width);
+        else
+            memcpy(result_row, row, (size_t) width * 4);
+    }
+}
+/* converts buffer into a flipped buffer with 1 (alpha, for MONO and 
+ * GREYSCALE only) or 4 (RGBA) channels that must be freed */
+unsigned char* wic_format_buffer(unsigned char* buffer, WicPair dimensions,
+                                 enum WicFormat format, unsigned channels)
+{
+    int width = (int) dimensions.x;
+    int height = (int) dimensions.y;
+    unsigned char* result = malloc((size_t) width * height * channels);
+    if(!result)
+        return (void*) wic_throw_error(WIC_ERRNO_NO_HEAP);
+    WicFormatRows rows = {buffer, result, dimensions, format, channels};
+    /* small buffers are not worth the overhead of splitting */
+    if((size_t) width * height < WIC_PARALLEL_FORMAT_PIXELS ||
+       !wic_parallel_for(height, 0, wic_format_rows, &rows))
+        wic_format_rows(0, height, &rows);
+    return result;
+}
+/* fetches the GL pixel format of a formatted buffer; core profiles have no
+ * alpha textures, so single channels are stored as red and swizzled */
+GLenum wic_get_gl_format(unsigned channels)
+{
+    if(channels == 1)
+        return wic_render_is_core() ? GL_RED : GL_ALPHA;
+    return GL_RGBA;
+}
+/* creates GL texture data from a formatted buffer, which may be null */
+void wic_create_texture_call(void* argument)
+{
+    WicTextureCall* call = argument;
+    glGenTextures(1, &call->data);
+    glBindTexture(GL_TEXTURE_2D, call->data);
+    if(call->wrap == WIC_STOP)
     {
         float color[] = { 1.0f, 1.0f, 1.0f, 0.0f };
         glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, color);
     }
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, dimensions.x, dimensions.y,
-                 0, GL_RGBA, GL_UNSIGNED_BYTE, formatted_buffer);
-    free(formatted_buffer);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, call->wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, call->wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, call->filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, call->filter);
+    GLenum format = wic_get_gl_format(call->channels);
+    GLint internal_format = format;
+    if(format == GL_RED)
+    {
+        GLint swizzle[] = {GL_ONE, GL_ONE, GL_ONE, GL_RED};
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+        internal_format = GL_R8;
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, internal_format, call->dimensions.x,
+                 call->dimensions.y, 0, format, GL_UNSIGNED_BYTE,
+                 call->buffer);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
     if(glGetError() == GL_OUT_OF_MEMORY)
     {
-        glDeleteTextures(1, &data);
-        return (void*) wic_throw_error(WIC_ERRNO_NO_GPU_MEM);
+        glDeleteTextures(1, &call->data);
+        call->data = 0;
     }
+}
+unsigned wic_create_texture_data(unsigned char* formatted_buffer,
+                                 WicPair dimensions, unsigned channels,
+                                 enum WicFilter filter, enum WicWrap wrap)
+{
+    WicTextureCall call = {formatted_buffer, dimensions, {0,0}, channels,
+                           filter, wrap, 0, 0};
+    wic_render_call(wic_create_texture_call, &call);
+    if(!call.data)
+        return wic_throw_error(WIC_ERRNO_NO_GPU_MEM);
+    return call.data;
+}
+/* copies a formatted buffer into part of existing GL texture data */
+void wic_update_texture_call(void* argument)
+{
+    WicTextureCall* call = argument;
+    glBindTexture(GL_TEXTURE_2D, call->data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, call->offset.x, call->offset.y,
+                    call->dimensions.x, call->dimensions.y,
+                    wic_get_gl_format(call->channels), GL_UNSIGNED_BYTE,
+                    call->buffer);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+void wic_update_texture_data(unsigned data, WicPair offset,
+                             unsigned char* formatted_buffer,
+                             WicPair dimensions, unsigned channels)
+{
+    WicTextureCall call = {formatted_buffer, dimensions, offset, channels,
+                           0, 0, 0, data};
+    wic_render_call(wic_update_texture_call, &call);
+}
+/* deletes GL texture data */
+void wic_delete_texture_call(void* argument)
+{
+    glDeleteTextures(1, &((WicTextureCall*) argument)->data);
+}
+void wic_delete_texture_data(unsigned data)
+{
+    WicTextureCall call = {0, {0,0}, {0,0}, 0, 0, 0, 0, data};
+    wic_render_call(wic_delete_texture_call, &call);
+}
+/* creates a texture from a formatted buffer, which may be null */
+WicTexture* wic_upload_texture(unsigned char* formatted_buffer,
+                               WicPair dimensions, unsigned channels,
+                               enum WicFilter filter, enum WicWrap wrap)
+{
+    unsigned data = wic_create_texture_data(formatted_buffer, dimensions,
+                                            channels, filter, wrap);
+    if(!data)
+        return 0;
     
     WicTexture* result = malloc(sizeof(WicTexture));
     if(!result)
     {
-        glDeleteTextures(1, &data);
+        wic_delete_texture_data(data);
         return (void*) wic_throw_error(WIC_ERRNO_NO_GPU_MEM);
     }
     result->data = data;
     result->dimensions = dimensions;
+    result->channels = channels;
+    result->status = WIC_TEXTURE_READY;
+    return result;
+}
+WicTexture* wic_init_texture_from_buffer(unsigned char* buffer,
+                                         WicPair dimensions,
+                                         enum WicFormat format,
+                                         enum WicFilter filter,
+                                         enum WicWrap wrap)
+{
+    if(!buffer)
+        return (void*) wic_throw_error(WIC_ERRNO_NULL_BUFFER);
+    if(dimensions.x < 1)
+        return (void*) wic_throw_error(WIC_ERRNO_SMALL_X_DIMENSION);
+    if(dimensions.y < 1)
+        return (void*) wic_throw_error(WIC_ERRNO_SMALL_Y_DIMENSION);
+    unsigned channels = 4;
+    if(format == WIC_MONO || format == WIC_GREYSCALE)
+        channels = 1;
+    unsigned char* formatted_buffer = wic_format_buffer(buffer, dimensions,
+                                                        format, channels);
+    if(!formatted_buffer)
+        return 0;
+    WicTexture* result = wic_upload_texture(formatted_buffer, dimensions,
+                                            channels, filter, wrap);
+    free(formatted_buffer);
     return result;
 }
 WicTexture* wic_init_texture_from_file(char* filepath, enum WicFilter filter,
@@ -169,6 +369,168 @@ WicTexture* wic_init_texture_from_file(char* filepath, enum WicFilter filter,
     SOIL_free_image_data(buffer);
     return result;
 }
+/* decodes and formats a queued file */
+void wic_load_job(void* argument)
+{
+    WicTextureJob* job = argument;
+    WIC_PROFILE_BEGIN("texture decode");
+    int x = 0;
+    int y = 0;
+    unsigned char* buffer = SOIL_load_image(job->filepath, &x, &y, 0,
+                                            SOIL_LOAD_RGBA);
+    if(buffer)
+    {
+        job->dimensions = (WicPair) {x,y};
+        job->pixels = wic_format_buffer(buffer, job->dimensions, WIC_RGBA, 4);
+        SOIL_free_image_data(buffer);
+    }
+    WIC_PROFILE_END("texture decode");
+    job->next = 0;
+    pthread_mutex_lock(&wic_loader_mutex);
+    if(wic_decoded_tail)
+        wic_decoded_tail->next = job;
+    else
+        wic_decoded_head = job;
+    wic_decoded_tail = job;
+    pthread_mutex_unlock(&wic_loader_mutex);
+}
+WicTexture* wic_init_texture_from_file_async(char* filepath,
+                                             enum WicFilter filter,
+                                             enum WicWrap wrap,
+                                             WicTextureCallback callback,
+                                             void* data)
+{
+    if(!filepath)
+        return (void*) wic_throw_error(WIC_ERRNO_NULL_FILEPATH);
+    WicTextureJob* job = calloc(1, sizeof(WicTextureJob));
+    if(!job)
+        return (void*) wic_throw_error(WIC_ERRNO_NO_HEAP);
+    job->filepath = strdup(filepath);
+    WicTexture* result = malloc(sizeof(WicTexture));
+    if(!job->filepath || !result)
+    {
+        free(job->filepath);
+        free(job);
+        free(result);
+        return (void*) wic_throw_error(WIC_ERRNO_NO_HEAP);
+    }
+    result->data = 0;
+    result->dimensions = (WicPair) {0,0};
+    result->channels = 4;
+    result->status = WIC_TEXTURE_LOADING;
+    job->texture = result;
+    job->filter = filter;
+    job->wrap = wrap;
+    job->callback = callback;
+    job->data = data;
+    if(!wic_submit_job(wic_load_job, job, 0))
+    {
+        free(job->filepath);
+        free(job);
+        free(result);
+        return 0;
+    }
+    return result;
+}
+/* streams a job's pixels to the GPU through the pixel buffer */
+void wic_upload_job_call(void* argument)
+{
+    WicTextureJob* job = ((WicTextureCall*) argument)->job;
+    size_t size = (size_t) job->dimensions.x * job->dimensions.y * 4;
+    if(!wic_pixel_buffer)
+        glGenBuffers(1, &wic_pixel_buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, wic_pixel_buffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, 0, GL_STREAM_DRAW);
+    void* mapped = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+    unsigned data;
+    if(mapped)
+    {
+        memcpy(mapped, job->pixels, size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        data = wic_create_texture_data(0, job->dimensions, 4, job->filter,
+                                       job->wrap);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    else
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        data = wic_create_texture_data(job->pixels, job->dimensions, 4,
+                                       job->filter, job->wrap);
+    }
+    ((WicTextureCall*) argument)->data = data;
+}
+unsigned wic_upload_job(WicTextureJob* job)
+{
+    WicTextureCall call = {0, {0,0}, {0,0}, 0, 0, 0, job, 0};
+    wic_render_call(wic_upload_job_call, &call);
+    return call.data;
+}
+unsigned wic_updt_textures()
+{
+    WIC_PROFILE_BEGIN("texture upload");
+    double start = glfwGetTime();
+    unsigned result = 0;
+    do
+    {
+        pthread_mutex_lock(&wic_loader_mutex);
+        WicTextureJob* job = wic_decoded_head;
+        if(job)
+        {
+            wic_decoded_head = job->next;
+            if(!wic_decoded_head)
+                wic_decoded_tail = 0;
+        }
+        pthread_mutex_unlock(&wic_loader_mutex);
+        if(!job)
+            break;
+        
+        WicTexture* texture = job->texture;
+        if(texture->status == WIC_TEXTURE_LOADING)
+        {
+            unsigned data = 0;
+            if(!job->pixels)
+                wic_throw_error(WIC_ERRNO_LOAD_FILE_FAIL);
+            else
+                data = wic_upload_job(job);
+            texture->data = data;
+            texture->dimensions = data ? job->dimensions : (WicPair) {0,0};
+            texture->status = data ? WIC_TEXTURE_READY : WIC_TEXTURE_FAILED;
+            if(job->callback)
+                job->callback(texture, data != 0, job->data);
+            result++;
+        }
+        free(job->pixels);
+        free(job->filepath);
+        free(job);
+    }
+    while(glfwGetTime() - start < wic_upload_budget);
+    WIC_PROFILE_COUNT("textures uploaded", result);
+    WIC_PROFILE_END("texture upload");
+    return result;
+}
+bool wic_set_texture_upload_budget(double budget)
+{
+    if(budget < 0)
+        return wic_throw_error(WIC_ERRNO_SMALL_BUDGET);
+    wic_upload_budget = budget;
+    return true;
+}
+enum WicTextureStatus wic_texture_get_status(WicTexture* target)
+{
+    if(!target)
+    {
+        wic_throw_error(WIC_ERRNO_NULL_TARGET);
+        return WIC_TEXTURE_FAILED;
+    }
+    return target->status;
+}
+size_t wic_texture_get_memory(WicTexture* target)
+{
+    if(!target)
+        return wic_throw_error(WIC_ERRNO_NULL_TARGET);
+    return (size_t) target->dimensions.x * target->dimensions.y *
+           target->channels;
+}
 WicPair wic_texture_get_dimensions(WicTexture* target)
 {
     if(!target)
@@ -183,9 +545,11 @@ bool wic_free_texture(WicTexture* target)
 {
     if(!target)
         return wic_throw_error(WIC_ERRNO_NULL_TARGET);
-    glDeleteTextures(1, &(target->data));
+    if(target->data)
+        wic_delete_texture_data(target->data);
     
     target->data = 0;
     target->dimensions = (WicPair) {0,0};
+    target->status = WIC_TEXTURE_FAILED;
     return true;
 }
@@ -0,0 +1,178 @@
+/* ----------------------------------------------------------------------------
+ * wic - a simple 2D game engine for Mac OSX written in C
+ * Copyright (C) 2013-2017  Willis O'Leary
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * ----------------------------------------------------------------------------
+ * File:    wic_transform.c
+ * ----------------------------------------------------------------------------
+ */
+#include "wic_transform.h"
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+WicTransform wic_get_transform(WicPair location, WicPair center,
+                               double rotation, WicPair scale,
+                               bool draw_centered)
+{
+    double cosine = cos(rotation);
+    double sine = sin(rotation);
+    WicTransform result;
+    result.a = cosine * scale.x;
+    result.b = sine * scale.x;
+    result.c = -sine * scale.y;
+    result.d = cosine * scale.y;
+    WicPair offset = location;
+    if(!draw_centered)
+        offset = wic_add_pairs(offset, center);
+    result.tx = offset.x - (result.a * center.x + result.c * center.y);
+    result.ty = offset.y - (result.b * center.x + result.d * center.y);
+    return result;
+}
+WicBounds wic_get_drawable_bounds(WicPair location, WicPair center,
+                                  double rotation, WicPair scale,
+                                  bool draw_centered, WicBounds bounds)
+{
+    WicPair pivot = location;
+    if(!draw_centered)
+        pivot = wic_add_pairs(pivot, center);
+    double x0 = (bounds.lower_left.x - center.x) * scale.x;
+    double x1 = (bounds.upper_right.x - center.x) * scale.x;
+    double y0 = (bounds.lower_left.y - center.y) * scale.y;
+    double y1 = (bounds.upper_right.y - center.y) * scale.y;
+    if(x0 > x1)
+    {
+        double swap = x0;
+        x0 = x1;
+        x1 = swap;
+    }
+    if(y0 > y1)
+    {
+        double swap = y0;
+        y0 = y1;
+        y1 = swap;
+    }
+    if(rotation == 0.0)
+        return (WicBounds) {(WicPair) {pivot.x + x0, pivot.y + y0},
+                            (WicPair) {pivot.x + x1, pivot.y + y1}};
+    double reach_x = x1 > -x0 ? x1 : -x0;
+    double reach_y = y1 > -y0 ? y1 : -y0;
+    double radius = sqrt(reach_x * reach_x + reach_y * reach_y);
+    return (WicBounds) {(WicPair) {pivot.x - radius, pivot.y - radius},
+                        (WicPair) {pivot.x + radius, pivot.y + radius}};
+}
+WicTransform wic_get_window_transform(WicPair window_dimensions)
+{
+    return (WicTransform) {2 / window_dimensions.x, 0, 0,
+                           2 / window_dimensions.y, -1, -1};
+}
+WicTransform wic_multiply_transforms(WicTransform a, WicTransform b)
+{
+    WicTransform result;
+    result.a = a.a * b.a + a.c * b.b;
+    result.b = a.b * b.a + a.d * b.b;
+    result.c = a.a * b.c + a.c * b.d;
+    result.d = a.b * b.c + a.d * b.d;
+    result.tx = a.a * b.tx + a.c * b.ty + a.tx;
+    result.ty = a.b * b.tx + a.d * b.ty + a.ty;
+    return result;
+}
+WicPair wic_apply_transform(WicTransform transform, WicPair pair)
+{
+    return (WicPair) {transform.a * pair.x + transform.c * pair.y +
+                      transform.tx,
+                      transform.b * pair.x + transform.d * pair.y +
+                      transform.ty};
+}
+void wic_transform_pairs(WicTransform transform, const WicPair* pairs,
+                         WicPair* result, unsigned num_pairs)
+{
+    unsigned i = 0;
+#if defined(__AVX__)
+    /* two pairs per vector: (x0 x0 x1 x1) * (a b a b) + (y0 y0 y1 y1) * 
+     * (c d c d) + (tx ty tx ty) */
+    const __m256d ab = _mm256_setr_pd(transform.a, transform.b, transform.a,
+                                      transform.b);
+    const __m256d cd = _mm256_setr_pd(transform.c, transform.d, transform.c,
+                                      transform.d);
+    const __m256d t = _mm256_setr_pd(transform.tx, transform.ty, transform.tx,
+                                     transform.ty);
+    for(; i + 2 <= num_pairs; i += 2)
+    {
+        __m256d pair = _mm256_loadu_pd(&pairs[i].x);
+        __m256d x = _mm256_movedup_pd(pair);
+        __m256d y = _mm256_permute_pd(pair, 0xF);
+        __m256d sum = _mm256_add_pd(_mm256_mul_pd(x, ab),
+                                    _mm256_mul_pd(y, cd));
+        _mm256_storeu_pd(&result[i].x, _mm256_add_pd(sum, t));
+    }
+#elif defined(__SSE2__)
+    const __m128d ab = _mm_setr_pd(transform.a, transform.b);
+    const __m128d cd = _mm_setr_pd(transform.c, transform.d);
+    const __m128d t = _mm_setr_pd(transform.tx, transform.ty);
+    for(; i < num_pairs; i++)
+    {
+        __m128d pair = _mm_loadu_pd(&pairs[i].x);
+        __m128d x = _mm_unpacklo_pd(pair, pair);
+        __m128d y = _mm_unpackhi_pd(pair, pair);
+        __m128d sum = _mm_add_pd(_mm_mul_pd(x, ab), _mm_mul_pd(y, cd));
+        _mm_storeu_pd(&result[i].x, _mm_add_pd(sum, t));
+    }
+#endif
+    for(; i < num_pairs; i++)
+        result[i] = wic_apply_transform(transform, pairs[i]);
+}
+void wic_transform_floats(WicTransform transform, const float* points,
+                          float* result, unsigned num_points)
+{
+    unsigned i = 0;
+    float a = transform.a, b = transform.b, c = transform.c, d = transform.d;
+    float tx = transform.tx, ty = transform.ty;
+#if defined(__AVX__)
+    /* four points per vector, duplicating each x and y across its point */
+    const __m256 ab = _mm256_setr_ps(a, b, a, b, a, b, a, b);
+    const __m256 cd = _mm256_setr_ps(c, d, c, d, c, d, c, d);
+    const __m256 t = _mm256_setr_ps(tx, ty, tx, ty, tx, ty, tx, ty);
+    for(; i + 4 <= num_points; i += 4)
+    {
+        __m256 point = _mm256_loadu_ps(&points[i*2]);
+        __m256 sum = _mm256_add_ps(_mm256_mul_ps(_mm256_moveldup_ps(point),
+                                                 ab),
+                                   _mm256_mul_ps(_mm256_movehdup_ps(point),
+                                                 cd));
+        _mm256_storeu_ps(&result[i*2], _mm256_add_ps(sum, t));
+    }
+#elif defined(__SSE2__)
+    const __m128 ab = _mm_setr_ps(a, b, a, b);
+    const __m128 cd = _mm_setr_ps(c, d, c, d);
+    const __m128 t = _mm_setr_ps(tx, ty, tx, ty);
+    for(; i + 2 <= num_points; i += 2)
+    {
+        __m128 point = _mm_loadu_ps(&points[i*2]);
+        __m128 x = _mm_shuffle_ps(point, point, _MM_SHUFFLE(2, 2, 0, 0));
+        __m128 y = _mm_shuffle_ps(point, point, _MM_SHUFFLE(3, 3, 1, 1));
+        __m128 sum = _mm_add_ps(_mm_mul_ps(x, ab), _mm_mul_ps(y, cd));
+        _mm_storeu_ps(&result[i*2], _mm_add_ps(sum, t));
+    }
+#endif
+    for(; i < num_points; i++)
+    {
+        float x = points[i*2];
+        float y = points[i*2+1];
+        result[i*2] = a * x + c * y + tx;
+        result[i*2+1] = b * x + d * y + ty;
+    }
+}